@@ -40,10 +40,12 @@ def main():
     config.prog_cxx()
 
     print_header( 'C++ compiler flags' )
-    # Pick highest level supported. oneAPI needs C++17.
+    # testsweeper.hh requires C++17, as in CMakeLists.txt.
     # Crusher had issue with -std=c++20 (2022-07).
-    config.prog_cxx_flag(
-        ['-std=c++17', '-std=c++14', '-std=c++11'])
+    config.prog_cxx_flag( '-std=c++17' )
+    if ('-std=c++17' not in config.environ['CXXFLAGS']):
+        raise Error( 'C++17 is required, but ' + config.environ['CXX']
+                     + ' does not support -std=c++17' )
     config.prog_cxx_flag( '-O2' )
     config.prog_cxx_flag( '-MMD' )
     config.prog_cxx_flag( '-Wall' )
@@ -0,0 +1,420 @@
+// Copyright (c) 2017-2023, University of Tennessee. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the BSD 3-Clause license. See the accompanying LICENSE file.
+
+// Example plugin, loaded at runtime by: tester --plugin ./tester_plugin.so
+
+#include <map>
+#include <numeric>
+#include <signal.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+    #include <sched.h>
+#endif
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+#include "test.hh"
+
+namespace {
+
+// -----------------------------------------------------------------------------
+// Plugin's own parameter, added to the tester's Params when loaded.
+testsweeper::ParamInt scale(
+    "scale", 5, testsweeper::ParamType::List, 1, 1, 1000,
+    "scale vector length by this factor (plugin)" );
+
+// -----------------------------------------------------------------------------
+// Sums vector 1, ..., n*scale with std::accumulate, and compares with
+// a simple loop as reference, and with exact sum n*scale*(n*scale + 1)/2.
+void test_sum( Params& params, bool run )
+{
+    using testsweeper::get_wtime;
+
+    // get & mark input and non-standard output values
+    int64_t n = params.dim.n() * scale();
+    params.gflops();
+    params.ref_time();
+    params.ref_gflops();
+
+    // adjust header to msec, as in test_sort
+    params.time.name( "time (ms)" );
+    params.ref_time.name( "ref time (ms)" );
+
+    if (! run)
+        return;
+
+    std::vector< double > x( n );
+    std::iota( x.begin(), x.end(), 1.0 );
+    double gflop = n * 1e-9;
+
+    double time = get_wtime();
+    double sum = std::accumulate( x.begin(), x.end(), 0.0 );
+    time = get_wtime() - time;
+    params.time()   = time * 1000;  // msec
+    params.gflops() = gflop / time;
+
+    time = get_wtime();
+    double sum_ref = 0;
+    for (int64_t i = 0; i < n; ++i) {
+        sum_ref += x[ i ];
+    }
+    time = get_wtime() - time;
+    params.ref_time()   = time * 1000;  // msec
+    params.ref_gflops() = gflop / time;
+
+    double exact = 0.5 * n * (n + 1);
+    double eps = std::numeric_limits< double >::epsilon();
+    params.error() = (std::abs( sum - exact ) + std::abs( sum_ref - exact ))
+                   / exact;
+    params.okay()  = (params.error() < params.tol() * eps);
+}
+
+// -----------------------------------------------------------------------------
+// Simulates a routine that crashes for large sizes, to exercise --isolate.
+// Sums as above, but kills itself when n > 200.
+void test_crash( Params& params, bool run )
+{
+    int64_t n = params.dim.n();
+    if (run && n > 200)
+        raise( SIGKILL );
+    test_sum( params, run );
+}
+
+// -----------------------------------------------------------------------------
+// Writes value to file dir/name, creating dir if needed.
+void write_counter( const char* dir, const char* name, long long value )
+{
+    mkdir( dir, 0755 );
+    std::string path = std::string( dir ) + "/" + name;
+    FILE* file = fopen( path.c_str(), "w" );
+    if (file == nullptr)
+        throw std::runtime_error( "can't write " + path );
+    fprintf( file, "%lld\n", value );
+    fclose( file );
+}
+
+// -----------------------------------------------------------------------------
+// Simulates RAPL counters in ./rapl_test, to test --energy-root rapl_test.
+// During the run, package 0 uses 3 J, wrapping around its counter range,
+// and package 1 uses 0.5 J. Subzone 0:0 is part of package 0, so ignored.
+void test_rapl( Params& params, bool run )
+{
+    if (! run)
+        return;
+
+    const long long range = 262143328850;
+    mkdir( "rapl_test", 0755 );
+    write_counter( "rapl_test/intel-rapl:0", "max_energy_range_uj", range );
+    write_counter( "rapl_test/intel-rapl:0", "energy_uj", range - 1000000 );
+    write_counter( "rapl_test/intel-rapl:0:0", "energy_uj", 5000 );
+    write_counter( "rapl_test/intel-rapl:1", "max_energy_range_uj", range );
+    write_counter( "rapl_test/intel-rapl:1", "energy_uj", 1000000 );
+
+    params.monitor_start();
+    write_counter( "rapl_test/intel-rapl:0", "energy_uj", 2000000 );
+    write_counter( "rapl_test/intel-rapl:0:0", "energy_uj", 999999999 );
+    write_counter( "rapl_test/intel-rapl:1", "energy_uj", 1500000 );
+    params.monitor_stop();
+
+    params.okay() = true;
+}
+
+// -----------------------------------------------------------------------------
+// Allocates n/100 vectors of 1000 doubles in the monitored region,
+// to test --alloc.
+void test_alloc( Params& params, bool run )
+{
+    int64_t n = params.dim.n();
+    if (! run)
+        return;
+
+    std::vector< std::vector< double > > x;
+    x.reserve( n / 100 );
+
+    params.monitor_start();
+    for (int64_t i = 0; i < n / 100; ++i) {
+        x.push_back( std::vector< double >( 1000, double( i ) ) );
+    }
+    params.monitor_stop();
+
+    params.okay() = (int64_t( x.size() ) == n / 100);
+}
+
+// -----------------------------------------------------------------------------
+// Checks that workspace buffers are aligned, poisoned with --poison,
+// and reused by repeated runs of the same size, once the workspace
+// stops growing.
+void test_workspace( Params& params, bool run )
+{
+    int64_t n = params.dim.n();
+    if (! run)
+        return;
+
+    static double* x_prev = nullptr;
+    static int64_t n_prev = 0;
+    static bool grew_prev = true;
+
+    testsweeper::Workspace& ws = params.workspace();
+    size_t capacity = ws.capacity();
+    double* x = ws.alloc< double >( n );
+    double* y = ws.alloc< double >( n, 4096 );
+
+    bool okay = uintptr_t( x ) % ws.alignment() == 0
+             && uintptr_t( y ) % 4096 == 0
+             && (n != n_prev || grew_prev || x == x_prev);
+    for (int64_t i = 0; i < n; ++i) {
+        if (ws.poison())
+            okay = okay && std::isnan( x[ i ] ) && std::isnan( y[ i ] );
+        x[ i ] = y[ i ] = i;
+    }
+    x_prev = x;
+    n_prev = n;
+    grew_prev = ws.capacity() != capacity;
+    params.okay() = okay;
+}
+
+// -----------------------------------------------------------------------------
+// Returns element i of x, of given type, as a real number; for complex,
+// element i of its real and imaginary parts.
+double real_value( testsweeper::DataType type, const void* x, int64_t i )
+{
+    using testsweeper::DataType;
+    switch (type) {
+        case DataType::Integer:
+            return ((const int64_t*) x)[ i ] * 0x1.0p-31;
+        case DataType::Half: {
+            // bits of half in (0, 1): exponent and mantissa
+            uint16_t h = ((const uint16_t*) x)[ i ];
+            return h == 0 ? 0 : ldexp( 1024 + (h & 0x3ff), (h >> 10) - 25 );
+        }
+        case DataType::Single:
+        case DataType::SingleComplex:
+            return ((const float*) x)[ i ];
+        case DataType::Double:
+        case DataType::DoubleComplex:
+            return ((const double*) x)[ i ];
+    }
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// Fills n random values of given type, checking that values are in [0, 1),
+// and that filling in two pieces matches filling at once.
+// Error is |mean - 0.5|, which is the same for any number of threads.
+void test_random( Params& params, bool run )
+{
+    using testsweeper::DataType;
+    int64_t n = params.dim.n();
+    DataType type = params.datatype();
+    if (! run)
+        return;
+
+    bool complex = (type == DataType::SingleComplex
+                    || type == DataType::DoubleComplex);
+    size_t size = type == DataType::Half   ? 2
+                : type == DataType::Single ? 4
+                : type == DataType::DoubleComplex ? 16 : 8;
+    std::vector< char > x( n * size ), y( n * size );
+
+    uint64_t seed = params.seed();
+    uint64_t key  = params.random_key();
+    testsweeper::random_fill( type, n, x.data(), seed, key );
+    int64_t n1 = n / 3;
+    testsweeper::random_fill( type, n1, y.data(), seed, key );
+    testsweeper::random_fill( type, n - n1, y.data() + n1*size, seed, key, n1 );
+
+    int64_t nreal = complex ? 2*n : n;
+    double sum = 0;
+    bool okay = (x == y);
+    for (int64_t i = 0; i < nreal; ++i) {
+        double value = real_value( type, x.data(), i );
+        okay = okay && 0 <= value && value < 1;
+        sum += value;
+    }
+    params.error() = std::abs( sum / nreal - 0.5 );
+    params.okay()  = okay && params.error() < 0.1;
+}
+
+// -----------------------------------------------------------------------------
+// Sorts random data as reference, checking that with --ref-cache, a cached
+// result matches, and the reference is saved at most once per point.
+void test_refcache( Params& params, bool run )
+{
+    int64_t n = params.dim.n();
+    if (! run)
+        return;
+
+    static std::map< uint64_t, int > stored;
+
+    std::vector< double > x( n );
+    testsweeper::random_fill( n, x.data(), params.seed(), params.random_key() );
+    size_t bytes = n * sizeof(double);
+    uint64_t key = params.ref_key( x.data(), bytes );
+    std::sort( x.begin(), x.end() );
+
+    bool okay = params.ref_cache();
+    auto cached = (const double*) params.ref_find( key, bytes );
+    if (cached != nullptr) {
+        okay = okay && std::equal( x.begin(), x.end(), cached );
+    }
+    else {
+        params.ref_store( key, x.data(), bytes );
+        stored[ key ] += 1;
+    }
+    params.okay() = okay && stored[ key ] <= 1;
+}
+
+// -----------------------------------------------------------------------------
+// Perturbs element n/2 of random data by one ULP (by 1 for integers) and
+// checks it with difference() and verify(), to show ulp and mismatch.
+void test_verify( Params& params, bool run )
+{
+    using testsweeper::DataType;
+    int64_t n = params.dim.n();
+    DataType type = params.datatype();
+    params.ulp();
+    params.mismatch();
+    if (! run)
+        return;
+
+    size_t size = type == DataType::Half   ? 2
+                : type == DataType::Single ? 4
+                : type == DataType::DoubleComplex ? 16 : 8;
+    std::vector< char > x( n * size ), y( n * size );
+    testsweeper::random_fill( type, n, y.data(), params.seed(),
+                              params.random_key() );
+    x = y;
+
+    double eps = 0;
+    char* xi = x.data() + (n/2)*size;
+    switch (type) {
+        case DataType::Integer:
+            *(int64_t*) xi += 1;
+            eps = 1;
+            break;
+        case DataType::Half:
+            *(uint16_t*) xi += 1;  // positive, so next larger
+            eps = 0x1.0p-10;
+            break;
+        case DataType::Single:
+        case DataType::SingleComplex:
+            *(float*) xi = std::nextafter( *(float*) xi, 2.0f );
+            eps = std::numeric_limits< float >::epsilon();
+            break;
+        case DataType::Double:
+        case DataType::DoubleComplex:
+            *(double*) xi = std::nextafter( *(double*) xi, 2.0 );
+            eps = std::numeric_limits< double >::epsilon();
+            break;
+    }
+    testsweeper::Difference diff
+        = testsweeper::difference( type, n, x.data(), y.data() );
+    params.verify( diff, params.tol() * eps );
+}
+
+// -----------------------------------------------------------------------------
+// Synthetic objective for --tune: Gflop/s is a parabola in nb with its
+// maximum of 100 at nb = n, so each search strategy should find nb = n.
+void test_tune( Params& params, bool run )
+{
+    int64_t n  = params.dim.n();
+    int64_t nb = params.nb();
+    params.gflops();
+    if (! run)
+        return;
+
+    double d = (nb - n) / 32.;
+    params.time()   = 1;
+    params.gflops() = 100 - d*d;
+    params.okay()   = true;
+}
+
+// -----------------------------------------------------------------------------
+// Synthetic time for --threads: by Amdahl's law with 20% serial work,
+// time is n (0.2 + 0.8/threads) microseconds, so speedup and efficiency
+// are exact.
+void test_scaling( Params& params, bool run )
+{
+    int64_t n = params.dim.n();
+    int64_t threads = std::max( params.threads(), int64_t( 1 ) );
+    params.time();
+    if (! run)
+        return;
+
+    params.time() = n * 1e-6 * (0.2 + 0.8 / threads);
+    params.okay() = true;
+}
+
+// -----------------------------------------------------------------------------
+// CPUs this process may run on, and number of OpenMP threads.
+std::vector< int > affinity()
+{
+    std::vector< int > cpus;
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO( &mask );
+    if (sched_getaffinity( 0, sizeof(mask), &mask ) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET( cpu, &mask ))
+                cpus.push_back( cpu );
+        }
+    }
+#endif
+    return cpus;
+}
+
+int max_threads()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+// as when plugin was loaded, before any --bind or --threads
+std::vector< int > start_affinity;
+int start_threads = 0;
+
+// -----------------------------------------------------------------------------
+// Checks that CPU affinity and number of threads are as when the plugin
+// was loaded, e.g., in a --spec block after one with --bind and --threads.
+void test_restored( Params& params, bool run )
+{
+    params.dim.n();
+    if (! run)
+        return;
+
+    params.okay() = affinity() == start_affinity
+                    && max_threads() == start_threads;
+}
+
+}  // namespace
+
+// -----------------------------------------------------------------------------
+extern "C"
+void testsweeper_plugin(
+    std::vector< testsweeper::routines_t >& routines,
+    testsweeper::ParamsBase& params )
+{
+    start_affinity = affinity();
+    start_threads  = max_threads();
+
+    params.add( &scale );
+    routines.push_back( { "sum",   test_sum,   Section::level1 } );
+    routines.push_back( { "crash", test_crash, Section::level1 } );
+    routines.push_back( { "rapl",  test_rapl,  Section::level1 } );
+    routines.push_back( { "alloc", test_alloc, Section::level1 } );
+    routines.push_back( { "workspace", test_workspace, Section::level1 } );
+    routines.push_back( { "random", test_random, Section::level1 } );
+    routines.push_back( { "refcache", test_refcache, Section::level1 } );
+    routines.push_back( { "verify", test_verify, Section::level1 } );
+    routines.push_back( { "tune", test_tune, Section::level1 } );
+    routines.push_back( { "scaling", test_scaling, Section::level1 } );
+    routines.push_back( { "restored", test_restored, Section::level1 } );
+}
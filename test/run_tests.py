@@ -56,6 +56,16 @@ cmds = [
     # Repeat, to see min, max, avg, std.
     [ 7, './tester --dim 1000:5000:1000 --repeat 4 sort', 20 ],
 
+    # Summary by type and size class; each repeat counts as a test,
+    # so n = 1000 fails twice for type d.
+    [ 8, './tester --summary y --type s,d --dim 100:1000:300 --repeat 2 sort', 2 ],
+
+    # Two more Params objects with independent values
+    [ 9, './tester --dim 100 params' ],
+
+    # Sweeps run in-process, collecting results with TableSink and CallbackSink
+    [ 10, './tester --dim 100 sinks' ],
+
     #----------
     # Types (enum)
     #
@@ -96,6 +106,21 @@ cmds = [
     # with illegal step = start = 0
     [ 208, './tester --nb 0:5 sort2', 255 ],
 
+    # geometric range, ratio
+    [ 209, './tester --dim 10:640:*4 sort2' ],
+
+    # geometric range, points per decade
+    [ 210, './tester --dim 1e2:1e4:x4/decade sort2', 5 ],
+
+    # geometric range, descending, and in zip of dimensions
+    [ 211, './tester --dim 8k:1k:*0.5x100 sort2' ],
+
+    # geometric range nb, points per octave
+    [ 212, './tester --nb 32:256:x2/octave --dim 100 sort2' ],
+
+    # with illegal start = 0
+    [ 213, './tester --nb 0:256:*2 sort2', 255 ],
+
     #----------
     # Zip of dimensions
     #
@@ -165,6 +190,193 @@ cmds = [
 
     # with start = 0, step != 0
     [ 606, './tester --beta 0:12.5:1.25 --dim 100 sort6' ],
+
+    # geometric float range
+    [ 607, './tester --beta 0.1:100:*10 --dim 100 sort6' ],
+
+    #----------
+    # Sweep specification files
+    #
+    # multiple blocks in one process
+    [ 700, './tester --spec spec_sort.txt' ],
+
+    # with parameters common to all blocks
+    [ 701, './tester --check n --spec spec_sort.txt' ],
+
+    # missing file
+    [ 702, './tester --spec missing.txt', 255 ],
+
+    # --bind and --threads of one block don't carry over to the next
+    [ 703, './tester --plugin ./tester_plugin.so --spec spec_restore.txt' ],
+
+    #----------
+    # Constraints
+    #
+    # m >= n
+    [ 800, './tester --dim 100:300:100*100:300:100 --where dim.m>=dim.n sort4' ],
+
+    # repeated --where, functions, and modulo
+    [ 801, './tester --dim 100:300:100*100:300:100 --nb 50:150:50'
+           + ' --where dim.m>=dim.n --where nb<=min(dim.m,dim.n)&&dim.n%nb==0 sort4' ],
+
+    # enum compared to char literal
+    [ 802, './tester --type s,d --dim 100:500:100 --where type==\'s\'||dim.m<300 sort4' ],
+
+    # no points satisfy constraint
+    [ 803, './tester --dim 100:300:100 --where dim.m>1000 sort4' ],
+
+    # unknown parameter
+    [ 804, './tester --where foo>1 sort4', 255 ],
+
+    # == binds looser than <, as in C: 1 == (dim.m < 300)
+    [ 809, './tester --dim 100:500:100 --where 1==dim.m<300 sort4' ],
+
+    #----------
+    # Derived parameters
+    #
+    # nb from dim
+    [ 805, './tester --dim 100:10k:*4 --nb =clamp(dim.m/16,32,512) sort4', 2 ],
+
+    # float beta from dim, with constraint on derived nb
+    [ 806, './tester --dim 100:500:100 --nb =dim.m/4 --beta =dim.n/100. --where nb%50==0 sort4' ],
+
+    # derived value out of range skips only that point: nb = 1.5M > 1M
+    [ 807, './tester --dim 300:100:-100 --nb =dim.m*5k sort4' ],
+
+    # parameter that can't be derived
+    [ 808, './tester --dim =100 sort4', 255 ],
+
+    #----------
+    # Plugins
+    #
+    # routine and parameter from plugin
+    [ 900, './tester --plugin ./tester_plugin.so --dim 100k:300k:100k --scale 1,10 sum' ],
+
+    # plugin's parameter is invalid for tester's routine
+    [ 901, './tester --plugin ./tester_plugin.so --scale 2 sort', 255 ],
+
+    # missing plugin
+    [ 902, './tester --plugin ./missing.so sum', 255 ],
+
+    #----------
+    # Tuning
+    # error doesn't depend on nb, so best nb is deterministic (first).
+    #
+    # grid search
+    [ 1000, './tester --dim 100,200 --nb 32:128:32 --tune nb --minimize error sort' ],
+
+    # golden-section search
+    [ 1001, './tester --dim 100,200 --nb 32:512:32 --tune nb --minimize error --tune-strategy golden sort' ],
+
+    # successive halving, with blank line between types
+    [ 1002, './tester --type s,d --dim 100 --nb 32:256:32 --tune nb --minimize error --tune-strategy halving sort' ],
+
+    # parameter to tune needs multiple values
+    [ 1003, './tester --nb 32 --tune nb sort', 255 ],
+
+    # unknown output
+    [ 1004, './tester --nb 32,64 --tune nb --maximize foo sort', 255 ],
+
+    # save best nb = 32 at size 100, and nb = 64 at size 400,
+    # each in its own database
+    [ 1005, './tester --dim 100 --nb 32:64:32 --tune nb --minimize error --tune-db tuning_1005.txt sort' ],
+    [ 1006, './tester --dim 400 --nb 64:128:32 --tune nb --minimize error --tune-db tuning_1006.txt sort' ],
+
+    # seed a database with sizes 100 and 400, then look up tuned nb,
+    # interpolating at size 200; type s wasn't tuned, so uses default nb
+    [ 1007, './tester --spec spec_tune.txt' ],
+
+    # plugin's tune routine has Gflop/s maximum at nb = dim.n,
+    # so each strategy finds best nb 96 and 224.
+    [ 1008, './tester --plugin ./tester_plugin.so --dim 96,224 --nb 32:512:32 --tune nb --maximize gflops tune' ],
+    [ 1009, './tester --plugin ./tester_plugin.so --dim 96,224 --nb 32:512:32 --tune nb --maximize gflops --tune-strategy golden tune' ],
+    [ 1010, './tester --plugin ./tester_plugin.so --dim 96,224 --nb 32:512:32 --tune nb --maximize gflops --tune-strategy halving tune' ],
+
+    # rejected points are counted once, not once per repeat;
+    # dim 32 has no feasible nb, and best feasible nb for dim 224 is 192
+    [ 1011, './tester --plugin ./tester_plugin.so --dim 32,224 --nb 32:512:32 --repeat 2 --where nb<dim.n --tune nb --maximize gflops tune' ],
+
+    # --tune runs in-process, so can't be used with --isolate or --workers
+    [ 1012, './tester --nb 32,64 --tune nb --isolate sort', 255 ],
+
+    # there's no default tuning database
+    [ 1013, './tester --nb tuned sort', 255 ],
+
+    #----------
+    # Isolation in child processes; output same as without --isolate.
+    [ 1100, './tester --isolate --dim 100:300:100 sort' ],
+    [ 1101, './tester --isolate 2 --type s,d --dim 100:300:100 sort' ],
+
+    # crash (signal) fails only that point, with error message
+    [ 1102, './tester --plugin ./tester_plugin.so --isolate --dim 100:300:100 crash', 1 ],
+
+    # worker processes; output in usual order, with stats
+    [ 1103, './tester --workers 3 --type s,d --dim 100:500:100 --repeat 2 sort' ],
+
+    # crashed worker is replaced
+    [ 1104, './tester --plugin ./tester_plugin.so --workers 2 --dim 100:400:100 crash', 2 ],
+
+    # bind to CPU 0; header shows CPUs and NUMA nodes (filtered, host-dependent)
+    [ 1105, './tester --bind 0 --dim 100:300:100 sort' ],
+
+    # invalid binding
+    [ 1106, './tester --bind foo sort', 255 ],
+
+    #----------
+    # Thread scaling. Speedup is relative to the first run with 1 thread,
+    # so is NA for 2 threads, run before it.
+    [ 1107, './tester --threads 2,1 --dim 100:200:100 sort' ],
+
+    # plugin's scaling routine has synthetic times, n (0.2 + 0.8/threads),
+    # so speedup is 1.67 for 2 threads and 2.50 for 4 threads.
+    [ 1119, './tester --plugin ./tester_plugin.so --threads 1,2,4 --dim 100,200 scaling' ],
+
+    # thread counts in a list must be positive
+    [ 1108, './tester --threads 0,2 sort', 255 ],
+
+    #----------
+    # NUMA memory placement
+    [ 1109, './tester --mem-policy local,interleave,default --dim 100:200:100 sort' ],
+
+    # invalid memory policy
+    [ 1110, './tester --mem-policy foo sort', 255 ],
+
+    #----------
+    # System noise columns and count of disturbed runs; their values vary,
+    # so are filtered.
+    [ 1120, './tester --noise --dim 100:300:100 sort' ],
+
+    #----------
+    # Energy from simulated RAPL counters: 3 J on package 0, wrapping around,
+    # plus 0.5 J on package 1
+    [ 1111, './tester --plugin ./tester_plugin.so --energy --energy-root rapl_test rapl' ],
+
+    # without RAPL counters, energy is NA
+    [ 1112, './tester --energy --energy-root ./missing --dim 100 sort' ],
+
+    #----------
+    # heap allocations in the monitored region: n/100 vectors of 8000 bytes
+    [ 1113, './tester --plugin ./tester_plugin.so --alloc --dim 100:300:100 alloc' ],
+
+    #----------
+    # workspace buffers are aligned, poisoned, and reused across repeats
+    [ 1114, './tester --plugin ./tester_plugin.so --poison --align 256 --repeat 2 --dim 100:300:100,200000 workspace' ],
+
+    # alignment must be a power of 2
+    [ 1115, './tester --align 3 sort', 255 ],
+
+    #----------
+    # random data is the same for any number of threads, and when filled
+    # in pieces; error is |mean - 0.5|
+    [ 1116, './tester --plugin ./tester_plugin.so --type i,h,s,d,c,z --threads 1,3 --dim 1000,100000 random' ],
+
+    #----------
+    # reference results are saved once per point, then reused
+    [ 1117, './tester --plugin ./tester_plugin.so --ref-cache ref_cache_test --repeat 2 --dim 100:300:100 refcache' ],
+
+    #----------
+    # verification: one element off by one ULP
+    [ 1118, './tester --plugin ./tester_plugin.so --type i,h,s,d,c,z --dim 1000 verify' ],
 ]
 
 #-------------------------------------------------------------------------------
@@ -200,6 +412,19 @@ def strip_time_sub( match ):
     return result
 # end
 
+#-------------------------------------------------------------------------------
+# Used in
+#     re.sub( pattern, strip_noise_sub, line )
+# where pattern matches status field to keep and 6 --noise fields after it
+# to replace with a hyphen each, keeping column widths.
+# If re.sub matched line 'pass     2400.5       0         0       2  ...',
+# this returns string    'pass          -       -         -       -  ...'
+#
+def strip_noise_sub( match ):
+    return match.group( 1 ) + re.sub( r' +\S+', lambda m: '-'.rjust( len( m.group() ) ),
+                                      match.group( 2 ) ) + '  '
+# end
+
 #-------------------------------------------------------------------------------
 # Runs cmd. Returns exit code and output (stdout and stderr merged).
 #
@@ -247,6 +472,20 @@ def run_test( num, cmd, expected_err=0 ):
         output2 = re.sub(
             r'(min|max|avg|stddev) +\d+\.\d+(e[+-]\d\d)?',
             r'\1 ---------', output2 )
+        # Strip out best, worst Gflop/s, where they occur, and speedup
+        # in --summary tables, keeping group, tests, and failed counts.
+        output2 = re.sub(
+            r'^(\S+ +\d+ +\d+)  +(?:\d+\.\d+|NA)  .*$',
+            r'\1  ---', output2, flags=re.M )
+        # Strip out --noise columns after status, and count of disturbed runs.
+        output2 = re.sub(
+            r'((?:pass|FAIL|no check) +)((?: +(?:\d+(?:\.\d+)?|NA)){6}) *$',
+            strip_noise_sub, output2, flags=re.M )
+        output2 = re.sub( r'^\d+ runs may be disturbed',
+                          r'--- runs may be disturbed', output2, flags=re.M )
+        # Strip out NUMA nodes of --bind, which depend on the host.
+        output2 = re.sub( r'; NUMA nodes .*$', r'; NUMA nodes ---',
+                          output2, flags=re.M )
         out = open( outfile, 'w' )
         out.write( output2 )
         out.close()
@@ -16,6 +16,8 @@
 using testsweeper::ParamType;
 using testsweeper::DataType;
 using testsweeper::DataType_help;
+using testsweeper::MemPolicy;
+using testsweeper::MemPolicy_help;
 
 #ifdef DEPRECATED
 using testsweeper::char2datatype;
@@ -39,14 +41,22 @@ const double pi      = 3.141592653589793;
 const double e       = 2.718281828459045;
 
 // -----------------------------------------------------------------------------
-// each section must have a corresponding entry in section_names
-enum Section {
-    newline = 0,  // zero flag forces newline
-    level1,
-    level2,
-    level3,
-    num_sections,  // last
+// Framework parameters declared in a compile-time schema;
+// misspelling a name in spec_find below is a compile error.
+constexpr testsweeper::ParamSpec framework_specs[] = {
+    // name,     w, p, type,     default, min,  max, help
+    { "tol",     0, 0, PT_Value,      50,   1, 1000, "tolerance (e.g., error < tol*epsilon to pass)" },
+    { "repeat",  0, 0, PT_Value,       1,   1, 1000, "times to repeat each test" },
+    { "verbose", 0, 0, PT_Value,       0,   0,   10, "verbose level" },
+    { "cache",   0, 0, PT_Value,      20,   1, 1024, "total cache size, in MiB" },
 };
+static_assert( testsweeper::spec_valid( framework_specs ),
+               "invalid framework parameter schema" );
+
+constexpr auto& tol_spec     = testsweeper::spec_find( framework_specs, "tol"     );
+constexpr auto& repeat_spec  = testsweeper::spec_find( framework_specs, "repeat"  );
+constexpr auto& verbose_spec = testsweeper::spec_find( framework_specs, "verbose" );
+constexpr auto& cache_spec   = testsweeper::spec_find( framework_specs, "cache"   );
 
 const char* section_names[] = {
    "",  // none
@@ -91,7 +101,7 @@ std::vector< testsweeper::routines_t > routines = {
 // Params class
 // List of parameters
 
-Params::Params():
+Params::Params( Registration ):
     ParamsBase(),
 
     // w = width
@@ -101,11 +111,14 @@ Params::Params():
     check     ( "check",      0, PT_Value, 'y', "ny", "check the results" ),
     ref       ( "ref",        0, PT_Value, 'n', "ny", "run reference; sometimes check implies ref" ),
 
-    //          name,         w, p, type, default,  min,  max, help
-    tol       ( "tol",        0, 0, PT_Value,  50,    1, 1000, "tolerance (e.g., error < tol*epsilon to pass)" ),
-    repeat    ( "repeat",     0,    PT_Value,   1,    1, 1000, "times to repeat each test" ),
-    verbose   ( "verbose",    0,    PT_Value,   0,    0,   10, "verbose level" ),
-    cache     ( "cache",      0,    PT_Value,  20,    1, 1024, "total cache size, in MiB" ),
+    // from compile-time schema, framework_specs
+    tol       ( tol_spec ),
+    repeat    ( repeat_spec ),
+    verbose   ( verbose_spec ),
+    cache     ( cache_spec ),
+
+    //          name,         w, type, default, valid, help
+    summary   ( "summary",    0, PT_Value, 'n', "ny", "print summary by type and size at end" ),
 
     //----- routine parameters, enums
     #ifdef DEPRECATED
@@ -131,6 +144,12 @@ Params::Params():
     beta      ( "beta",       3, 1, PT_List,       e, -inf,  inf, "scalar beta" ),
     grid      ( "grid",       3,    PT_List,   "1x1",    0,  1e6, "MPI grid p by q dimensions" ),
 
+    // 0 leaves number of threads as set by OMP_NUM_THREADS
+    threads   ( "threads",    7,    PT_List,       0,    0,  1e6, "number of OpenMP threads, set before each point; 0 leaves it unchanged" ),
+
+    //          name,         w, type,    default, help
+    mem_policy( "mem-policy", 10, PT_List, MemPolicy::Default, MemPolicy_help ),
+
     //----- output parameters
     // min, max are ignored
     // error:   %8.2e allows 9.99e-99
@@ -139,6 +158,13 @@ Params::Params():
     //          name,         w, p, type,   default, min, max, help
     error     ( "error",      8, 2, PT_Out, no_data, 0, 0, "numerical error" ),
     ortho     ( "orth.",      8, 2, PT_Out, no_data, 0, 0, "orthogonality error" ),
+    //          name,         w, type,  default, min, max, help
+    ulp       ( "ulp",        6, PT_Out,     0, 0, 0, "max ULP distance from reference, with verify()" ),
+    mismatch  ( "mismatch",   8, PT_Out,    -1, -1, 0, "index of first mismatch with reference, with verify()" ),
+    // speedup and efficiency are set by framework for --threads list
+    //          name,         w, p, type,   default, min, max, help
+    speedup   ( "speedup",    7, 2, PT_Out, no_data, 0, 0, "speedup relative to smallest number of threads" ),
+    efficiency( "efficiency", 10, 2, PT_Out, no_data, 0, 0, "parallel efficiency, speedup / threads ratio" ),
     time      ( "time (s)",   9, 3, PT_Out, no_data, 0, 0, "time to solution" ),
     gflops    ( "Gflop/s",   12, 3, PT_Out, no_data, 0, 0, "Gflop/s rate" ),
 
@@ -148,6 +174,26 @@ Params::Params():
     // default -1 means "no check"
     //          name,         w, type, default, min, max, help
     okay      ( "status",     6, PT_Out,    -1, 0, 0, "success indicator" ),
+
+    // set by framework with --energy, --alloc, and --noise;
+    // after status, so times are last before it
+    //          name,         w, p, type,   default, min, max, help
+    energy    ( "energy (J)", 10, 3, PT_Out, no_data, 0, 0, "energy of run, from RAPL counters" ),
+    gflop_per_joule
+              ( "Gflop/J",    10, 3, PT_Out, no_data, 0, 0, "Gflop/s per watt" ),
+    //          name,         w, type,  default, min, max, help
+    allocs    ( "allocs",     6, PT_Out,     0, 0, 0, "heap allocations during run" ),
+    alloc_bytes
+              ( "alloc bytes", 11, PT_Out,   0, 0, 0, "bytes of heap allocations during run" ),
+    peak_rss  ( "peak RSS (MiB)", 14, PT_Out, -1, -1, 0, "growth of peak resident memory during run" ),
+    freq      ( "freq (MHz)", 10, 0, PT_Out, no_data, 0, 0, "average CPU frequency during run" ),
+    //          name,         w, type,  default, min, max, help
+    vol_cs    ( "vol cs",     6, PT_Out,     0, 0, 0, "voluntary context switches" ),
+    invol_cs  ( "invol cs",   8, PT_Out,     0, 0, 0, "involuntary context switches" ),
+    minflt    ( "minflt",     6, PT_Out,     0, 0, 0, "minor page faults" ),
+    majflt    ( "majflt",     6, PT_Out,     0, 0, 0, "major page faults" ),
+    disturbed ( "disturbed",  9, PT_Out,     0, 0, 0, "1 if run may be disturbed by system noise" ),
+
     msg       ( "",           1, PT_Out,    "",       "error message" )
 {
     // mark standard set of output fields as used
@@ -161,10 +207,123 @@ Params::Params():
     repeat();
     verbose();
     cache();
+    summary();
+    threads();
+    mem_policy();
 
     // routine's parameters are marked by the test routine; see main
 }
 
+// -----------------------------------------------------------------------------
+/// Prints arguments, quoting them if necessary, followed by newline.
+void print_args( int nargs, char** args )
+{
+    for (int i = 0; i < nargs; ++i) {
+        // quote arg if necessary
+        std::string arg( args[i] );
+        const char* wordchars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-=";
+        if (arg.find_first_not_of( wordchars ) != std::string::npos)
+            printf( " '%s'", args[i] );
+        else
+            printf( " %s", args[i] );
+    }
+    printf( "\n" );
+}
+
+// -----------------------------------------------------------------------------
+/// Prints results as the default PrintSink, plus a blank line between
+/// datatypes, and prints a summary at the end with `--summary y`.
+class TesterSink : public testsweeper::PrintSink< Params >
+{
+public:
+    virtual void begin( Params& params )
+    {
+        last_ = params.datatype();
+        PrintSink::begin( params );
+    }
+
+    virtual void begin_point( Params& params )
+    {
+        if (params.datatype() != last_) {
+            last_ = params.datatype();
+            printf( "\n" );
+        }
+    }
+
+    virtual void result( Params& params, int iter )
+    {
+        PrintSink::result( params, iter );
+        if (params.summary() == 'y') {
+            summary_.add( to_string( params.datatype() ), params.dim.m(),
+                          params.gflops(), params.ref_gflops(),
+                          params.okay() );
+        }
+    }
+
+    virtual void end( Params& params, int failures )
+    {
+        PrintSink::end( params, failures );
+        if (params.summary() == 'y') {
+            summary_.rejected( params.rejected() );
+            summary_.repeat( params.repeat() );
+            summary_.print();
+        }
+    }
+
+protected:
+    testsweeper::DataType last_;
+    testsweeper::Summary summary_;
+};
+
+// -----------------------------------------------------------------------------
+/// Parses parameters and runs tests for one routine.
+///
+/// @param[in,out] params
+///     Parameters, in their default state.
+///
+/// @param[in] index
+///     Index of routines by name.
+///
+/// @param[in] nargs
+///     Number of arguments.
+///
+/// @param[in] args
+///     Arguments: [parameters] routine.
+///
+/// @param[in] argv0
+///     Name of tester, for usage.
+///
+/// @return number of failed tests.
+///
+int run_routine( Params& params, testsweeper::RoutineIndex const& index,
+                 int nargs, char** args, char* argv0 )
+{
+    // find routine to test
+    const char* routine = args[ nargs-1 ];
+    testsweeper::test_func_ptr test_routine = find_tester( routine, index );
+    if (test_routine == nullptr) {
+        usage( 1, &argv0, routines, section_names );
+        throw std::runtime_error(
+            std::string("routine ") + routine + " not found" );
+    }
+
+    // mark fields that are used (run=false)
+    test_routine( params, false );
+
+    // parse parameters up to routine name
+    try {
+        params.parse( routine, nargs-1, args );
+    }
+    catch (const std::exception& ex) {
+        params.help( routine );
+        throw;
+    }
+
+    // run tests
+    TesterSink sink;
+    return testsweeper::run_sweep( params, test_routine, sink );
+}
+
 // -----------------------------------------------------------------------------
 int main( int argc, char** argv )
 {
@@ -180,6 +339,18 @@ int main( int argc, char** argv )
     // check that all sections have names
     assert( sizeof(section_names)/sizeof(*section_names) == Section::num_sections );
 
+    // add routines registered via TESTSWEEPER_ROUTINE after the last routine
+    // in the same section, so usage lists each section once
+    for (auto const& routine : testsweeper::registered_routines()) {
+        auto last = std::find_if(
+            routines.rbegin(), routines.rend(),
+            [&routine] (testsweeper::routines_t const& r) {
+                return r.section == routine.section;
+            } );
+        routines.insert( last == routines.rend() ? routines.end() : last.base(),
+                         routine );
+    }
+
     int status = 0;
     try {
         int version = testsweeper::version();
@@ -189,19 +360,19 @@ int main( int argc, char** argv )
 
         // print input so running `test [input] > out.txt` documents input
         printf( "input: %s", argv[0] );
-        for (int i = 1; i < argc; ++i) {
-            // quote arg if necessary
-            std::string arg( argv[i] );
-            const char* wordchars = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-=";
-            if (arg.find_first_not_of( wordchars ) != std::string::npos)
-                printf( " '%s'", argv[i] );
-            else
-                printf( " %s", argv[i] );
+        print_args( argc-1, argv+1 );
+
+        // Usage: test [--plugin lib.so ...] [params] routine
+        // Plugins add routines and parameters, so are loaded first.
+        Params params;
+        int arg0 = 1;
+        while (arg0 + 1 < argc && strcmp( argv[ arg0 ], "--plugin" ) == 0) {
+            testsweeper::load_plugin( argv[ arg0+1 ], routines, params );
+            arg0 += 2;
         }
-        printf( "\n" );
 
         // Usage: test [params] routine
-        if (argc < 2
+        if (argc - arg0 < 1
             || strcmp( argv[argc-1], "-h" ) == 0
             || strcmp( argv[argc-1], "--help" ) == 0)
         {
@@ -209,73 +380,33 @@ int main( int argc, char** argv )
             throw QuitException();
         }
 
-        // find routine to test
-        const char* routine = argv[ argc-1 ];
-        testsweeper::test_func_ptr test_routine = find_tester( routine, routines );
-        if (test_routine == nullptr) {
-            usage( argc, argv, routines, section_names );
-            throw std::runtime_error(
-                std::string("routine ") + routine + " not found" );
-        }
-
-        // mark fields that are used (run=false)
-        Params params;
-        test_routine( params, false );
-
-        // parse parameters up to routine name
-        try {
-            params.parse( routine, argc-2, argv+1 );
-        }
-        catch (const std::exception& ex) {
-            params.help( routine );
-            throw;
-        }
-
-        // run tests
-        int repeat = params.repeat();
-        std::vector<double> times( repeat ), ref_times( repeat ),
-                            gflops( repeat ), ref_gflops( repeat );
-        testsweeper::DataType last = params.datatype();
-        params.header();
-        do {
-            if (params.datatype() != last) {
-                last = params.datatype();
-                printf( "\n" );
-            }
-            for (int iter = 0; iter < repeat; ++iter) {
-                try {
-                    test_routine( params, true );
+        // index routines once, after plugins have added theirs
+        testsweeper::RoutineIndex index( routines );
+
+        if (argc - arg0 >= 2 && strcmp( argv[argc-2], "--spec" ) == 0) {
+            // Usage: test [params] --spec file
+            // Run each block in spec file back-to-back in this process,
+            // re-using the same Params, reset to defaults between blocks.
+            // Params before --spec are common to all blocks.
+            auto blocks = testsweeper::read_spec( argv[argc-1] );
+            for (size_t b = 0; b < blocks.size(); ++b) {
+                std::vector< char* > args( argv + arg0, argv + argc - 2 );
+                for (auto& arg : blocks[ b ]) {
+                    args.push_back( &arg[0] );
                 }
-                catch (const std::exception& ex) {
-                    fprintf( stderr, "%s%sError: %s%s\n",
-                             ansi_bold, ansi_red, ex.what(), ansi_normal );
-                    params.okay() = false;
+                if (b > 0) {
+                    params.reset();
                 }
-
-                // Collect stats.
-                times     [ iter ] = params.time();
-                gflops    [ iter ] = params.gflops();
-                ref_times [ iter ] = params.ref_time();
-                ref_gflops[ iter ] = params.ref_gflops();
-
-                params.print();
-                status += ! params.okay();
-                params.reset_output();
-            }
-            if (repeat > 1) {
-                testsweeper::print_stats( params.time,       times      );
-                testsweeper::print_stats( params.ref_time,   ref_times  );
-                testsweeper::print_stats( params.gflops,     gflops     );
-                testsweeper::print_stats( params.ref_gflops, ref_gflops );
                 printf( "\n" );
+                printf( "spec:" );
+                print_args( args.size(), args.data() );
+                status += run_routine( params, index,
+                                       args.size(), args.data(), argv[0] );
             }
-        } while( params.next() );
-
-        if (status) {
-            printf( "%d tests FAILED.\n", status );
         }
         else {
-            printf( "All tests passed.\n" );
+            status = run_routine( params, index,
+                                  argc - arg0, argv + arg0, argv[0] );
         }
     }
     catch (const QuitException& ex) {
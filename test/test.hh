@@ -8,13 +8,25 @@
 
 #include "testsweeper.hh"
 
+// -----------------------------------------------------------------------------
+// each section must have a corresponding entry in section_names
+enum Section {
+    newline = 0,  // zero flag forces newline
+    level1,
+    level2,
+    level3,
+    num_sections,  // last
+};
+
 //------------------------------------------------------------------------------
 class Params: public testsweeper::ParamsBase {
 public:
     const double inf = std::numeric_limits<double>::infinity();
     const double nan = std::numeric_limits<double>::quiet_NaN();
 
-    Params();
+    // Registration lasts until the constructor finishes,
+    // registering exactly the members below.
+    Params( Registration reg = Registration() );
 
     // Field members are explicitly public.
     // Order here determines output order.
@@ -25,6 +37,7 @@ public:
     testsweeper::ParamInt    repeat;
     testsweeper::ParamInt    verbose;
     testsweeper::ParamInt    cache;
+    testsweeper::ParamChar   summary;
 
     //----- routine parameters, enums
     #ifdef DEPRECATED
@@ -40,9 +53,17 @@ public:
     testsweeper::ParamDouble  beta;
     testsweeper::ParamInt3    grid;
 
+    //----- framework parameters, applied before each point
+    testsweeper::ParamInt     threads;
+    testsweeper::ParamEnum< testsweeper::MemPolicy > mem_policy;
+
     //----- output parameters
     testsweeper::ParamScientific error;
     testsweeper::ParamScientific ortho;
+    testsweeper::ParamInt        ulp;
+    testsweeper::ParamInt        mismatch;
+    testsweeper::ParamDouble     speedup;
+    testsweeper::ParamDouble     efficiency;
     testsweeper::ParamDouble     time;
     testsweeper::ParamDouble     gflops;
 
@@ -50,6 +71,24 @@ public:
     testsweeper::ParamDouble     ref_gflops;
 
     testsweeper::ParamOkay       okay;
+
+    //----- energy, set by framework with --energy
+    testsweeper::ParamDouble     energy;
+    testsweeper::ParamDouble     gflop_per_joule;
+
+    //----- memory, set by framework with --alloc
+    testsweeper::ParamInt        allocs;
+    testsweeper::ParamInt        alloc_bytes;
+    testsweeper::ParamInt        peak_rss;
+
+    //----- system noise, set by framework with --noise
+    testsweeper::ParamDouble     freq;
+    testsweeper::ParamInt        vol_cs;
+    testsweeper::ParamInt        invol_cs;
+    testsweeper::ParamInt        minflt;
+    testsweeper::ParamInt        majflt;
+    testsweeper::ParamInt        disturbed;
+
     testsweeper::ParamString     msg;
 };
 
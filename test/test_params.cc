@@ -0,0 +1,80 @@
+// Copyright (c) 2017-2023, University of Tennessee. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the BSD 3-Clause license. See the accompanying LICENSE file.
+
+#include "test.hh"
+
+// -----------------------------------------------------------------------------
+/// Parses args, as "--option value" pairs, into params for routine sort.
+static void parse_args( Params& params, std::vector< std::string > args )
+{
+    test_sort( params, false );
+    std::vector< char* > argv;
+    for (auto& arg : args)
+        argv.push_back( &arg[ 0 ] );
+    params.parse( "sort", argv.size(), argv.data() );
+}
+
+// -----------------------------------------------------------------------------
+/// Old-style parameters, whose constructor takes no Registration.
+class OldParams: public testsweeper::ParamsBase
+{
+public:
+    OldParams():
+        ParamsBase(),
+        nb( "nb", 4, testsweeper::ParamType::List, 32, 1, 1024, "block size" )
+    {}
+
+    testsweeper::ParamInt nb;
+};
+
+// -----------------------------------------------------------------------------
+/// Checks that two Params objects, beside the tester's own, coexist with
+/// independent values, and that a parameter constructed after them isn't
+/// registered with either. Checks that an old-style subclass without a
+/// Registration still registers its members, until parsed, and that a
+/// ParamInt spec with a precision is rejected.
+static void test_params( Params& params, bool run )
+{
+    params.dim.m();
+    if (! run)
+        return;
+
+    Params a, b;
+    testsweeper::ParamInt other(
+        "other", 0, testsweeper::ParamType::Value, 0, 0, 10, "not registered" );
+
+    parse_args( a, { "--dim", "100" } );
+    parse_args( b, { "--dim", "200", "--nb", "64" } );
+
+    OldParams old;
+    bool old_okay = old.find( "nb" ) == &old.nb;
+    char arg0[] = "--nb", arg1[] = "64";
+    char* old_args[] = { arg0, arg1 };
+    old.nb();
+    old.parse( "old", 2, old_args );
+    testsweeper::ParamInt after(
+        "after", 0, testsweeper::ParamType::Value, 0, 0, 10, "not registered" );
+    old_okay = old_okay && old.nb() == 64 && after.owner() == nullptr;
+
+    constexpr testsweeper::ParamSpec bad_spec =
+        { "bad", 0, 2, testsweeper::ParamType::Value, 0, 0, 10, "precision" };
+    bool spec_okay = false;
+    try {
+        testsweeper::ParamInt bad( bad_spec );
+    }
+    catch (std::exception const&) {
+        spec_okay = true;
+    }
+
+    params.okay() = old_okay && spec_okay
+                 && a.dim.m() == 100 && a.nb() == 384
+                 && b.dim.m() == 200 && b.nb() == 64
+                 && a.find( "nb" ) == &a.nb && b.find( "nb" ) == &b.nb
+                 && a.nb.owner() == &a && b.nb.owner() == &b
+                 && other.owner() == nullptr && params.find( "other" ) == nullptr;
+}
+
+// registered here instead of in test.cc's routines table
+TESTSWEEPER_ROUTINE( "params", test_params, Section::level1 );
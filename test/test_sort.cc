@@ -74,9 +74,9 @@ public:
 // In this case, it sorts the vector x, using C++ std::sort.
 //
 template <typename scalar_t>
-void my_sort( std::vector<scalar_t>& x )
+void my_sort( size_t n, scalar_t* x )
 {
-    std::sort( x.begin(), x.end() );
+    std::sort( x, x + n );
 }
 
 // -----------------------------------------------------------------------------
@@ -96,20 +96,20 @@ int compare( const void* x, const void* y )
 // In this case, it sorts the vector x, using C's qsort.
 //
 template <typename T>
-void ref_sort( std::vector<T>& x )
+void ref_sort( size_t n, T* x )
 {
-    qsort( &x[0], x.size(), sizeof(T), compare<T> );
+    qsort( x, n, sizeof(T), compare<T> );
 }
 
 // -----------------------------------------------------------------------------
 // Print vector.
 //
 template <typename T>
-void print( const char* label, std::vector<T>& x )
+void print( const char* label, size_t n, const T* x )
 {
     printf( "%s = [\n", label );
-    for (auto x_i: x) {
-        printf( "  %9.6f\n", x_i );
+    for (size_t i = 0; i < n; ++i) {
+        printf( "  %9.6f\n", x[ i ] );
     }
     printf( "];\n" );
 }
@@ -163,14 +163,17 @@ void test_sort_work( Params &params, bool run )
     // setup
     int64_t imax = 100000;
     size_t len = std::min( m, imax ) + std::min( n, imax ) + std::min( k, imax );
-    std::vector<real_t> x( len );
-    for (auto& x_i: x) {
-        x_i = rand() / double(RAND_MAX) + std::abs( alpha ) + beta;
+    // workspace is reused across runs and placed by --mem-policy
+    real_t* x     = params.workspace().alloc< real_t >( len );
+    real_t* x_ref = params.workspace().alloc< real_t >( len );
+    testsweeper::random_fill( len, x, params.seed(), params.random_key() );
+    for (size_t i = 0; i < len; ++i) {
+        x[ i ] += std::abs( alpha ) + beta;
     }
-    std::vector<real_t> x_ref = x;  // copy
+    std::copy( x, x + len, x_ref );
 
     if (verbose >= 2) {
-        print( "x_in", x );
+        print( "x_in", len, x );
     }
 
     double time;
@@ -178,37 +181,54 @@ void test_sort_work( Params &params, bool run )
 
     // run test
     testsweeper::flush_cache( cache );
+    params.monitor_start();  // narrow --noise, --energy, etc. to timed region
     time = get_wtime();
-    my_sort( x );
+    my_sort( len, x );
     time = get_wtime() - time;
+    params.monitor_stop();
     params.time()   = time * 1000;  // msec
     params.gflops() = gflop / time;
 
     if (verbose >= 2) {
-        print( "x_out", x );
+        print( "x_out", len, x );
     }
 
-    if (ref) {
+    // with --ref-cache, reuse reference result from an earlier run;
+    // ref time is then NA
+    const real_t* ref_result = x_ref;
+    size_t bytes = len * sizeof(real_t);
+    uint64_t key = 0;
+    const void* cached = nullptr;
+    if (ref && params.ref_cache()) {
+        key = params.ref_key( x_ref, bytes );
+        cached = params.ref_find( key, bytes );
+    }
+
+    if (cached != nullptr) {
+        ref_result = (const real_t*) cached;
+    }
+    else if (ref) {
         // run reference
         testsweeper::flush_cache( cache );
         time = get_wtime();
-        ref_sort( x_ref );  // reference implementation
+        ref_sort( len, x_ref );  // reference implementation
         time = get_wtime() - time;
         params.ref_time()   = time * 1000;  // msec
         params.ref_gflops() = gflop / time;
 
-        if (verbose >= 2) {
-            print( "x_ref", x_ref );
-        }
+        params.ref_store( key, x_ref, bytes );
+    }
+
+    if (ref && verbose >= 2) {
+        print( "x_ref", len, ref_result );
     }
 
     // check error
     if (check) {
-        real_t error = 0;
-        error = 1.23456e-17 * n;  // placeholder; fails for n >= 900
-        for (size_t i = 0; i < len; ++i) {
-            error += std::abs( x[i] - x_ref[i] );
-        }
+        testsweeper::Difference diff
+            = testsweeper::difference( len, x, ref_result );
+        real_t error = 1.23456e-17 * n  // placeholder; fails for n >= 900
+                     + diff.max_abs;
         real_t eps = std::numeric_limits< real_t >::epsilon();
         real_t tol = params.tol() * eps;
         params.error() = error;
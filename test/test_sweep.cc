@@ -0,0 +1,76 @@
+// Copyright (c) 2017-2023, University of Tennessee. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the BSD 3-Clause license. See the accompanying LICENSE file.
+
+#include "test.hh"
+
+// -----------------------------------------------------------------------------
+/// @return value of column name in row, or NaN if row has no such column.
+static double column( std::vector< testsweeper::ParamValue > const& row,
+                      const char* name, std::string* text=nullptr )
+{
+    for (auto const& value : row) {
+        if (value.name == name) {
+            if (text)
+                *text = value.text;
+            return value.value;
+        }
+    }
+    return std::numeric_limits< double >::quiet_NaN();
+}
+
+// -----------------------------------------------------------------------------
+/// Runs sort sweeps in-process with run_sweep, collecting results as data
+/// with TableSink and CallbackSink, and checks the values.
+static void test_sinks( Params& params, bool run )
+{
+    params.dim.m();
+    if (! run)
+        return;
+
+    std::vector< testsweeper::routines_t > routines = {
+        { "sort", test_sort, Section::level1 },
+    };
+    bool okay = true;
+
+    // one row per point and repeat, with values of used columns
+    Params table_params;
+    testsweeper::TableSink< Params > table;
+    int failures = testsweeper::run_sweep(
+        table_params, routines,
+        { "--dim", "100:300:100", "--repeat", "2", "sort" }, table );
+    auto const& rows = table.rows();
+    okay = okay && failures == 0 && rows.size() == 6;
+    for (size_t i = 0; i < rows.size() && okay; ++i) {
+        std::string type;
+        column( rows[ i ], "type", &type );
+        okay = type == "d"
+            && column( rows[ i ], "dim.m" ) == 100 * (i/2 + 1)
+            && column( rows[ i ], "nb" ) == 384
+            && column( rows[ i ], "status" ) == 1
+            && column( rows[ i ], "error" ) > 0
+            && column( rows[ i ], "time (ms)" ) >= 0;
+    }
+
+    // callback reads outputs directly; n = 1000 fails;
+    // routine is found in a prebuilt index
+    testsweeper::RoutineIndex index( routines );
+    Params callback_params;
+    std::vector< std::pair< char, int64_t > > calls;
+    testsweeper::CallbackSink< Params > callback(
+        [&calls] (Params& p) {
+            calls.push_back( { char( p.datatype() ), p.okay() } );
+        } );
+    failures = testsweeper::run_sweep(
+        callback_params, index,
+        { "--type", "s,d", "--dim", "100,1000", "sort" }, callback );
+    std::vector< std::pair< char, int64_t > > expect = {
+        { 's', 1 }, { 's', 1 }, { 'd', 1 }, { 'd', 0 }
+    };
+    okay = okay && failures == 1 && calls == expect;
+
+    params.okay() = okay;
+}
+
+TESTSWEEPER_ROUTINE( "sinks", test_sinks, Section::level1 );
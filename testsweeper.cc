@@ -5,9 +5,33 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <string>
 #include <cmath>
+#include <atomic>
+#include <new>
+#include <set>
+
+#ifdef __linux__
+    #include <sched.h>
+    #include <sys/syscall.h>
+#endif
+
+#ifndef _WIN32
+    #include <dirent.h>
+    #include <dlfcn.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <sys/mman.h>
+    #include <sys/resource.h>
+    #include <sys/stat.h>
+    #include <sys/utsname.h>
+    #include <sys/wait.h>
+#endif
 
 // prefer OpenMP get_wtime; else use gettimeofday
 #ifdef _OPENMP
@@ -104,9 +128,18 @@ const char* DataType_help =
     " c64, z, or complex-double;"
     " i, int, or integer";
 
+const char* MemPolicy_help =
+    "NUMA memory placement, one of:"
+    " default (first touch),"
+    " local,"
+    " interleave (over all nodes),"
+    " remote (on other nodes than bound CPUs)";
+
 // -----------------------------------------------------------------------------
 // static class variables
-std::vector< ParamBase* > ParamBase::s_params;
+thread_local ParamsBase::Registration*
+    ParamsBase::Registration::s_current = nullptr;
+thread_local ParamsBase* ParamsBase::s_constructing = nullptr;
 
 // -----------------------------------------------------------------------------
 // Compare a == b, bitwise. Returns true if a and b are both the same NaN value,
@@ -230,24 +263,127 @@ int64_t scan_multiplier( const char **pstr )
     }
 }
 
+//------------------------------------------------------------------------------
+/// Scans geometric step of range, after the colon:
+/// `*ratio` multiplies by ratio each step, e.g., `1k:1M:*2`;
+/// `xN/decade` takes N points per factor of 10, e.g., `1e3:1e9:x10/decade`;
+/// `xN/octave` takes N points per factor of 2.
+///
+/// @param[in,out] pstr
+///     Pointer to string to scan, after the colon.
+///     On exit, if a geometric step was scanned, updated to point after it.
+///
+/// @param[out] ratio
+///     Ratio between consecutive values; 0 if no geometric step was scanned.
+///
+/// @retval 1: failure; geometric step has invalid syntax
+/// @retval 0: success
+///
+static int scan_ratio( const char** pstr, double* ratio )
+{
+    const char* str = *pstr;
+    double num;
+    int bytes = 0;
+    *ratio = 0;
+    if (sscanf( str, " * %lf %n", &num, &bytes ) == 1) {
+        *ratio = num;
+    }
+    else if (sscanf( str, " x %lf %n", &num, &bytes ) == 1) {
+        // points per decade or octave
+        str += bytes;
+        bytes = 0;
+        double base = 0;
+        if (strncmp( str, "/decade", 7 ) == 0) {
+            base  = 10;
+            bytes = 7;
+        }
+        else if (strncmp( str, "/octave", 7 ) == 0) {
+            base  = 2;
+            bytes = 7;
+        }
+        if (base == 0 || num <= 0)
+            return 1;  // failure
+        *ratio = pow( base, 1/num );
+    }
+    else {
+        return 0;  // not geometric
+    }
+    *pstr = str + bytes;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/// Completes range after start, end, step, and ratio are scanned,
+/// setting defaults for omitted end and step.
+/// @see scan_range.
+///
+/// @param[in] cnt
+///     Count of numbers scanned (start, end, step), or
+///     3 if geometric step was scanned.
+///
+/// @retval 1: failure
+/// @retval 0: success
+///
+template <typename T>
+static int finish_range( int cnt, T* start, T* end, T* step, double* ratio )
+{
+    if (cnt == 3) {
+        if (*start == *end) {
+            *step  = 0;
+            *ratio = 0;
+        }
+    }
+    else if (cnt == 2) {
+        if (*start == *end)
+            *step = 0;
+        else
+            *step = *start;
+    }
+    else if (cnt == 1) {
+        *end  = *start;
+        *step = 0;
+    }
+    else {
+        return 1;  // failure
+    }
+    if (*ratio != 0) {
+        *step = 0;
+        return ! ((*ratio > 1 && *start > 0 && *start < *end) ||
+                  (*ratio > 0 && *ratio < 1 && *end > 0 && *start > *end));
+    }
+    return ! ((*step == 0 && *start == *end) ||
+              (*step >  0 && *start <  *end) ||
+              (*step <  0 && *start >  *end));
+}
+
 ///-----------------------------------------------------------------------------
-/// Scans string for single integer or range of integers (start:end:step).
+/// Scans string for single integer or range of integers.
 /// Advances the string to after the range or number.
+/// Ranges can be arithmetic, start:end:step, or geometric,
+/// start:end:*ratio or start:end:xN/decade (N points per decade)
+/// or start:end:xN/octave (N points per octave).
+/// Geometric values are rounded to the nearest integer, removing duplicates.
+/// Numbers can have metric or binary prefix; @see scan_multiplier.
 ///
 /// @param[in,out] pstr: pointer to string containing an integer or range.
 ///                      On output, advanced to after the number or range.
 /// @param[out] start: start of range
 /// @param[out] end:   end of range
-/// @param[out] step:  step size; default is start; 0 if start = end.
+/// @param[out] step:  step size; default is start; 0 if start = end
+///                    or range is geometric.
+/// @param[out] ratio: ratio between values for geometric range;
+///                    0 for arithmetic range.
 ///
 /// @retval 1: failure
 /// @retval 0: success
 ///
-int scan_range( const char** pstr, int64_t* start, int64_t* end, int64_t* step )
+int scan_range( const char** pstr, int64_t* start, int64_t* end, int64_t* step,
+                double* ratio )
 {
     long long start_ = 0, end_ = 0, step_ = 0;
     int bytes;
     const char* str = *pstr;
+    *ratio = 0;
 
     // cnt of numbers scanned (start, end, step).
     int cnt = 0;
@@ -266,12 +402,25 @@ int scan_range( const char** pstr, int64_t* start, int64_t* end, int64_t* step )
             str += bytes;
             end_ *= scan_multiplier( &str );
 
-            // Step number.
-            info = sscanf( str, " : %lld %n", &step_, &bytes );
-            if (info == 1) {
-                cnt += 1;
-                str += bytes;
-                step_ *= scan_multiplier( &str );
+            // Step number, or geometric ratio.
+            bytes = 0;
+            sscanf( str, " :%n", &bytes );
+            if (bytes > 0) {
+                const char* str2 = str + bytes;
+                if (scan_ratio( &str2, ratio ) != 0)
+                    return 1;  // failure
+                if (*ratio != 0) {
+                    cnt += 1;
+                    str = str2;
+                }
+            }
+            if (*ratio == 0) {
+                info = sscanf( str, " : %lld %n", &step_, &bytes );
+                if (info == 1) {
+                    cnt += 1;
+                    str += bytes;
+                    step_ *= scan_multiplier( &str );
+                }
             }
         }
     }
@@ -280,69 +429,157 @@ int scan_range( const char** pstr, int64_t* start, int64_t* end, int64_t* step )
     *start = start_;
     *end   = end_;
     *step  = step_;
-    if (cnt == 3) {
-        if (*start == *end)
-            *step = 0;
-    }
-    else if (cnt == 2) {
-        if (*start == *end)
-            *step = 0;
-        else
-            *step = *start;
-    }
-    else if (cnt == 1) {
-        *end  = *start;
-        *step = 0;
-    }
-    else {
-        return 1;  // failure
-    }
-    return ! ((*step == 0 && *start == *end) ||
-              (*step >  0 && *start <  *end) ||
-              (*step <  0 && *start >  *end));
+    return finish_range( cnt, start, end, step, ratio );
+}
+
+///-----------------------------------------------------------------------------
+/// Scans string for single integer or arithmetic range of integers
+/// (start:end:step). Geometric ranges are not allowed.
+/// @see scan_range with ratio.
+///
+/// @retval 1: failure
+/// @retval 0: success
+///
+int scan_range( const char** pstr, int64_t* start, int64_t* end, int64_t* step )
+{
+    double ratio;
+    int info = scan_range( pstr, start, end, step, &ratio );
+    return info || ratio != 0;
 }
 
 ///-----------------------------------------------------------------------------
-/// Scans string for a double or range of doubles (start:end:step).
+/// Scans string for a double or range of doubles.
 /// Advances the string to after the number or range.
+/// Ranges can be arithmetic, start:end:step, or geometric,
+/// start:end:*ratio or start:end:xN/decade (N points per decade)
+/// or start:end:xN/octave (N points per octave).
 ///
 /// @param[in,out] pstr: pointer to string containing a double or range.
 ///                      On output, advanced to after the number or range.
 /// @param[out] start: start of range
 /// @param[out] end:   end of range
-/// @param[out] step:  step size; default is start; 0 if start = end.
+/// @param[out] step:  step size; default is start; 0 if start = end
+///                    or range is geometric.
+/// @param[out] ratio: ratio between values for geometric range;
+///                    0 for arithmetic range.
 ///
 /// @retval 1: failure
 /// @retval 0: success
 ///
-int scan_range( const char** pstr, double* start, double* end, double* step )
+int scan_range( const char** pstr, double* start, double* end, double* step,
+                double* ratio )
 {
     int bytes1, bytes2, bytes3, cnt;
-    cnt = sscanf( *pstr, "%lf %n: %lf %n: %lf %n",
-                  start, &bytes1, end, &bytes2, step, &bytes3 );
-    if (cnt == 3) {
-        if (*start == *end)
-            *step = 0;
-        *pstr += bytes3;
-    }
-    else if (cnt == 2) {
-        *pstr += bytes2;
-        if (*start == *end)
-            *step = 0;
-        else
-            *step = *start;
+    *ratio = 0;
+    cnt = sscanf( *pstr, "%lf %n: %lf %n", start, &bytes1, end, &bytes2 );
+    if (cnt == 2) {
+        // Step number, or geometric ratio.
+        const char* str = *pstr + bytes2;
+        bytes3 = 0;
+        sscanf( str, ":%n", &bytes3 );
+        if (bytes3 > 0) {
+            str += bytes3;
+            if (scan_ratio( &str, ratio ) != 0)
+                return 1;  // failure
+            if (*ratio != 0) {
+                cnt = 3;
+                *pstr = str;
+            }
+            else if (sscanf( str, " %lf %n", step, &bytes3 ) == 1) {
+                cnt = 3;
+                *pstr = str + bytes3;
+            }
+        }
+        if (cnt == 2)
+            *pstr += bytes2;
     }
     else if (cnt == 1) {
         *pstr += bytes1;
-        *end  = *start;
-        *step = 0;
+    }
+    return finish_range( cnt, start, end, step, ratio );
+}
+
+///-----------------------------------------------------------------------------
+/// Scans string for a double or arithmetic range of doubles
+/// (start:end:step). Geometric ranges are not allowed.
+/// @see scan_range with ratio.
+///
+/// @retval 1: failure
+/// @retval 0: success
+///
+int scan_range( const char** pstr, double* start, double* end, double* step )
+{
+    double ratio;
+    int info = scan_range( pstr, start, end, step, &ratio );
+    return info || ratio != 0;
+}
+
+//------------------------------------------------------------------------------
+/// Appends values in integer range to list.
+/// For arithmetic range, values are start, start + step, ..., up to end.
+/// For geometric range, values are start, start*ratio, start*ratio^2, ...,
+/// up to end, rounded to nearest integer, with duplicates removed.
+///
+void append_range( std::vector< int64_t >& values,
+                   int64_t start, int64_t end, int64_t step, double ratio )
+{
+    if (start == end) {
+        values.push_back( start );
+    }
+    else if (ratio != 0) {
+        // allow for rounding error in pow
+        double end_ = (ratio > 1 ? end * (1 + 1e-12) : end * (1 - 1e-12));
+        size_t first = values.size();
+        for (int i = 0; ; ++i) {
+            double val = start * pow( ratio, i );
+            if (ratio > 1 ? val > end_ : val < end_)
+                break;
+            int64_t ival = llround( val );
+            if (values.size() == first || ival != values.back())
+                values.push_back( ival );
+        }
     }
     else {
-        return 1;  // failure
+        for (int64_t val = start;
+             (step >= 0 ? val <= end : val >= end);
+             val += step)
+        {
+            values.push_back( val );
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+/// Appends values in floating point range to list.
+/// For arithmetic range, values are start, start + step, ..., up to end.
+/// For geometric range, values are start, start*ratio, start*ratio^2, ...,
+/// up to end.
+///
+void append_range( std::vector< double >& values,
+                   double start, double end, double step, double ratio )
+{
+    if (start == end) {
+        values.push_back( start );
+    }
+    else if (ratio != 0) {
+        // allow for rounding error in pow
+        double end_ = (ratio > 1 ? end * (1 + 1e-12) : end * (1 - 1e-12));
+        for (int i = 0; ; ++i) {
+            double val = start * pow( ratio, i );
+            if (ratio > 1 ? val > end_ : val < end_)
+                break;
+            values.push_back( val );
+        }
+    }
+    else {
+        end += step / 10.;  // avoid rounding issues
+        for (double val = start;
+             (step >= 0 ? val <= end : val >= end);
+             val += step)
+        {
+            values.push_back( val );
+        }
     }
-    return ! ((*step == 0 && *start == *end) ||
-              (*step >  0 && *start <  *end) ||
-              (*step <  0 && *start >  *end));
 }
 
 // -----------------------------------------------------------------------------
@@ -378,246 +615,585 @@ void flush_cache( size_t cache_size )
     free( buf );
 }
 
-// =============================================================================
-// ParamBase class
-
 // -----------------------------------------------------------------------------
-// if name has \n, for line=0, print 1st line; for line=1, print 2nd line.
-// otherwise,      for line=0, print blank;    for line=1, print name.
-// virtual
-void ParamBase::header( int line ) const
-{
-    if (used_ && width_ > 0) {
-        size_t i = name_.find( '\n' );
-        std::string str;
-        if (i != std::string::npos) {
-            str = (line == 0
-                ? name_.substr( 0, i ).c_str()
-                : name_.substr( i+1 ).c_str() );
-        }
-        else {
-            str = (line == 0
-                ? ""
-                : name_.c_str() );
-        }
-        printf( "%*s  ", width_, str.c_str() );
-    }
-}
+// Counter-based random numbers, Philox4x32-10 (Salmon et al., SC 2011).
+// Block b of 4 random 32-bit words depends only on the seed, key, and b,
+// so any element can be generated independently of the others.
+// Verified against the Random123 known answer for counter 0, key 0.
 
-// -----------------------------------------------------------------------------
-// virtual
-void ParamBase::help() const
+/// @return high 32 bits of a*b, and low 32 bits in lo.
+static inline uint32_t mulhilo( uint32_t a, uint32_t b, uint32_t* lo )
 {
-    if (type_ == ParamType::Value || type_ == ParamType::List) {
-        printf( "    %-16s %s\n", option_.c_str(), help_.c_str() );
-    }
+    uint64_t product = uint64_t( a ) * b;
+    *lo = uint32_t( product );
+    return uint32_t( product >> 32 );
 }
 
-// -----------------------------------------------------------------------------
-// virtual
-bool ParamBase::next()
+/// Number of blocks generated together, so the rounds vectorize.
+static const int philox_batch = 16;
+
+/// Sets w[ k ][ l ] to word k of block b + l of random words, for blocks
+/// b, ..., b + philox_batch - 1, for given seed and key.
+static inline void philox( uint64_t b, uint64_t seed, uint64_t key,
+                           uint32_t w[ 4 ][ philox_batch ] )
 {
-    assert( index_ >= 0 && index_ < size() );
-    if (index_ == size() - 1) {
-        index_ = 0;
-        return false;
+    uint32_t* c0 = w[ 0 ];
+    uint32_t* c1 = w[ 1 ];
+    uint32_t* c2 = w[ 2 ];
+    uint32_t* c3 = w[ 3 ];
+    #pragma omp simd
+    for (int l = 0; l < philox_batch; ++l) {
+        c0[ l ] = uint32_t( b + l );
+        c1[ l ] = uint32_t( (b + l) >> 32 );
+        c2[ l ] = uint32_t( key );
+        c3[ l ] = uint32_t( key >> 32 );
     }
-    else {
-        index_ += 1;
-        return true;
+    uint32_t k0 = uint32_t( seed ), k1 = uint32_t( seed >> 32 );
+    for (int round = 0; round < 10; ++round) {
+        #pragma omp simd
+        for (int l = 0; l < philox_batch; ++l) {
+            uint32_t lo0, lo1;
+            uint32_t hi0 = mulhilo( 0xD2511F53, c0[ l ], &lo0 );
+            uint32_t hi1 = mulhilo( 0xCD9E8D57, c2[ l ], &lo1 );
+            c0[ l ] = hi1 ^ c1[ l ] ^ k0;
+            c1[ l ] = lo1;
+            c2[ l ] = hi0 ^ c3[ l ] ^ k1;
+            c3[ l ] = lo0;
+        }
+        k0 += 0x9E3779B9;
+        k1 += 0xBB67AE85;
     }
 }
 
-// =============================================================================
-// ParamInt class
-// Integer parameters
-
-// -----------------------------------------------------------------------------
-// virtual
-void ParamInt::parse( const char *str )
+/// Fills x[ 0 : n-1 ] with elements offset, ..., offset + n - 1 of the
+/// random sequence for seed and key. Each block of 4 words makes
+/// per_block elements; convert( w, j ) makes element j from words w[ 0:3 ].
+/// Blocks are independent, so batches of blocks run in parallel, and
+/// the result doesn't depend on the number of threads.
+template <int per_block, typename T, typename Convert>
+static void philox_fill( int64_t n, T* x, uint64_t seed, uint64_t key,
+                         int64_t offset, Convert convert )
 {
-    while (true) {
-        int64_t start, end, step;
-        if (scan_range( &str, &start, &end, &step ) != 0) {
-            throw_error( "invalid argument at '%s',"
-                         " expected integer or range start:end:step", str );
-        }
-        if (start == end) {
-            push_back( start );
+    if (n <= 0)
+        return;
+    int64_t begin = offset / per_block;
+    int64_t end   = (offset + n - 1) / per_block + 1;
+    int64_t nbatch = ceildiv( end - begin, philox_batch );
+    #pragma omp parallel for schedule( static )
+    for (int64_t batch = 0; batch < nbatch; ++batch) {
+        uint32_t w[ 4 ][ philox_batch ];
+        int64_t b0 = begin + batch*philox_batch;
+        philox( b0, seed, key, w );
+        int64_t lanes = std::min( int64_t( philox_batch ), end - b0 );
+        int64_t i0 = b0*per_block - offset;
+        if (lanes == philox_batch && i0 >= 0
+            && i0 + philox_batch*per_block <= n)
+        {
+            // whole batch is in x
+            T* xb = &x[ i0 ];
+            #pragma omp simd
+            for (int l = 0; l < philox_batch; ++l) {
+                uint32_t words[ 4 ] = { w[ 0 ][ l ], w[ 1 ][ l ],
+                                        w[ 2 ][ l ], w[ 3 ][ l ] };
+                for (int j = 0; j < per_block; ++j)
+                    xb[ l*per_block + j ] = convert( words, j );
+            }
         }
         else {
-            for (int64_t val = start; val <= end; val += step) {
-                push_back( val );
+            for (int64_t l = 0; l < lanes; ++l) {
+                uint32_t words[ 4 ] = { w[ 0 ][ l ], w[ 1 ][ l ],
+                                        w[ 2 ][ l ], w[ 3 ][ l ] };
+                for (int j = 0; j < per_block; ++j) {
+                    int64_t i = i0 + l*per_block + j;
+                    if (0 <= i && i < n)
+                        x[ i ] = convert( words, j );
+                }
             }
         }
-        if (*str == '\0') {
-            break;
-        }
-        if (*str != ',' && *str != ';') {
-            throw_error( "invalid argument at '%s', expected comma", str );
-        }
-        str += 1;
     }
 }
 
 // -----------------------------------------------------------------------------
-void ParamInt::push_back( int64_t val )
+/// Fills x with n random values, uniform in [0, 1), from the counter-based
+/// Philox generator. Element i is element offset + i of the sequence for
+/// (seed, key), so filling a buffer in pieces with matching offsets gives
+/// the same result as filling it at once, regardless of the number of
+/// threads. Typically, key is params.random_key() and seed is params.seed().
+///
+/// @param[in] n
+///     Number of elements.
+///
+/// @param[out] x
+///     Array of length n.
+///
+/// @param[in] seed
+///     Seed of the sequence.
+///
+/// @param[in] key
+///     Key selecting an independent sequence, e.g., for each sweep point.
+///
+/// @param[in] offset
+///     Position in the sequence of x[ 0 ].
+///
+void random_fill( int64_t n, double* x, uint64_t seed, uint64_t key,
+                  int64_t offset )
 {
-    if (val < min_value_ || val > max_value_) {
-        throw_error( "invalid argument, %lld outside [%lld, %lld]",
-                     (long long) val,
-                     (long long) min_value_,
-                     (long long) max_value_ );
-    }
-    TParamBase<int64_t>::push_back( val );
+    philox_fill< 2 >(
+        n, x, seed, key, offset,
+        []( uint32_t const* w, int j ) {
+            // 53 random bits
+            uint64_t bits = (uint64_t( w[ 2*j ] ) << 32) | w[ 2*j + 1 ];
+            return (bits >> 11) * 0x1.0p-53;
+        } );
 }
 
-// -----------------------------------------------------------------------------
-// virtual
-void ParamInt::print() const
+/// @see random_fill( int64_t, double*, uint64_t, uint64_t, int64_t )
+void random_fill( int64_t n, float* x, uint64_t seed, uint64_t key,
+                  int64_t offset )
 {
-    if (used_ && width_ > 0) {
-        printf( "%*lld  ", width_, (long long) values_[ index_ ] );
-    }
+    philox_fill< 4 >(
+        n, x, seed, key, offset,
+        []( uint32_t const* w, int j ) {
+            // 24 random bits
+            return float( (w[ j ] >> 8) * 0x1.0p-24 );
+        } );
 }
 
-// -----------------------------------------------------------------------------
-// virtual
-void ParamInt::help() const
+/// Real and imaginary parts are each uniform in [0, 1).
+/// @see random_fill( int64_t, double*, uint64_t, uint64_t, int64_t )
+void random_fill( int64_t n, std::complex<double>* x,
+                  uint64_t seed, uint64_t key, int64_t offset )
 {
-    if (type_ == ParamType::Value || type_ == ParamType::List) {
-        printf( "    %-16s %s; default %lld\n",
-                option_.c_str(), help_.c_str(), (long long) default_value_ );
-    }
+    random_fill( 2*n, (double*) x, seed, key, 2*offset );
 }
 
-// =============================================================================
-// ParamOkay class
-// same as ParamInt, but prints pass (for non-zero) or FAILED (for zero).
-
-// -----------------------------------------------------------------------------
-// virtual
-void ParamOkay::print() const
+/// Real and imaginary parts are each uniform in [0, 1).
+/// @see random_fill( int64_t, double*, uint64_t, uint64_t, int64_t )
+void random_fill( int64_t n, std::complex<float>* x,
+                  uint64_t seed, uint64_t key, int64_t offset )
 {
-    if (used_ && width_ > 0) {
-        const char *msg = "";
-        switch (values_[ index_ ]) {
-            case  0: msg = "FAILED";   break;
-            case  1: msg = "pass";     break;
-            case no_check: msg = "no check"; break;
-            case skipped:  msg = "skipped";  break;
-        }
-        printf( "%-*s  ", width_, msg );
-    }
+    random_fill( 2*n, (float*) x, seed, key, 2*offset );
 }
 
-// =============================================================================
-// ParamInt3 class
-// Integer 3-tuple parameters for M x N x K dimensions
+/// Integers are uniform in [0, 2^31).
+/// @see random_fill( int64_t, double*, uint64_t, uint64_t, int64_t )
+void random_fill( int64_t n, int64_t* x, uint64_t seed, uint64_t key,
+                  int64_t offset )
+{
+    philox_fill< 4 >(
+        n, x, seed, key, offset,
+        []( uint32_t const* w, int j ) {
+            return int64_t( w[ j ] >> 1 );
+        } );
+}
 
-// -----------------------------------------------------------------------------
-// virtual
-void ParamInt3::parse( const char *str )
+/// Fills x of given type: int64_t for Integer; IEEE binary16 bits
+/// (uint16_t) for Half; float, double, std::complex<float>, or
+/// std::complex<double> for the others.
+/// @see random_fill( int64_t, double*, uint64_t, uint64_t, int64_t )
+void random_fill( DataType type, int64_t n, void* x,
+                  uint64_t seed, uint64_t key, int64_t offset )
 {
-    int64_t m_start, m_end, m_step;
-    int64_t n_start, n_end, n_step;
-    int64_t k_start, k_end, k_step;
-    int len;
-    while (true) {
-        // scan M
-        if (scan_range( &str, &m_start, &m_end, &m_step ) != 0) {
-            throw_error( "invalid m dimension at '%s', "
-                         "expected integer or range start:end:step", str );
+    switch (type) {
+        case DataType::Integer:
+            random_fill( n, (int64_t*) x, seed, key, offset );
+            break;
+        case DataType::Half:
+            philox_fill< 4 >(
+                n, (uint16_t*) x, seed, key, offset,
+                []( uint32_t const* w, int j ) {
+                    // 11 random bits, k * 2^-11 for k in [0, 2048),
+                    // which are exact as half: exponent and 10 bit mantissa
+                    uint32_t k = w[ j ] >> 21;
+                    if (k == 0)
+                        return uint16_t( 0 );
+                    int e = 31;
+                    while ((k & (1u << e)) == 0)
+                        --e;
+                    uint32_t mantissa = (k << (10 - e)) & 0x3ff;
+                    return uint16_t( ((e - 11 + 15) << 10) | mantissa );
+                } );
+            break;
+        case DataType::Single:
+            random_fill( n, (float*) x, seed, key, offset );
+            break;
+        case DataType::Double:
+            random_fill( n, (double*) x, seed, key, offset );
+            break;
+        case DataType::SingleComplex:
+            random_fill( n, (std::complex<float>*) x, seed, key, offset );
+            break;
+        case DataType::DoubleComplex:
+            random_fill( n, (std::complex<double>*) x, seed, key, offset );
+            break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Verification kernels: element-wise differences between a result x and
+// reference y, reduced in parallel; see difference().
+
+/// Half precision value, as IEEE binary16 bits.
+struct Half {
+    uint16_t bits;
+};
+
+/// @return value of half precision bits, including subnormal, inf, and NaN.
+static inline double to_double( Half h )
+{
+    int exponent = (h.bits >> 10) & 0x1f;
+    int mantissa = h.bits & 0x3ff;
+    double value = exponent == 0  ? ldexp( mantissa, -24 )
+                 : exponent == 31 ? (mantissa == 0 ? INFINITY : NAN)
+                 : ldexp( 1024 + mantissa, exponent - 25 );
+    return (h.bits & 0x8000) ? -value : value;
+}
+
+/// @return |x - y| and |y|, in double precision.
+static inline double abs_diff( Half x, Half y )
+    { return std::abs( to_double( x ) - to_double( y ) ); }
+static inline double abs_val( Half y )
+    { return std::abs( to_double( y ) ); }
+
+template <typename T>
+static inline double abs_diff( T x, T y )
+    { return std::abs( x - y ); }
+template <typename T>
+static inline double abs_val( T y )
+    { return std::abs( y ); }
+
+static inline double abs_diff( int64_t x, int64_t y )
+    { return std::abs( double( x ) - double( y ) ); }
+
+/// @return |a - b| for ordered representations a, b, saturated to int64 max.
+static inline int64_t ordered_distance( int64_t a, int64_t b )
+{
+    uint64_t d = a > b ? uint64_t( a ) - uint64_t( b )
+                       : uint64_t( b ) - uint64_t( a );
+    return int64_t( std::min( d, uint64_t( INT64_MAX ) ) );
+}
+
+/// @return number of representable values between x and y, i.e., ULP
+/// distance, by mapping sign-magnitude bits to ordered integers.
+static inline int64_t ulp( Half x, Half y )
+{
+    auto ordered = []( uint16_t bits ) {
+        return (bits & 0x8000) ? -int64_t( bits & 0x7fff ) : int64_t( bits );
+    };
+    return ordered_distance( ordered( x.bits ), ordered( y.bits ) );
+}
+
+static inline int64_t ulp( float x, float y )
+{
+    auto ordered = []( float v ) {
+        int32_t bits;
+        memcpy( &bits, &v, sizeof(bits) );
+        return bits >= 0 ? int64_t( bits ) : int64_t( INT32_MIN ) - bits;
+    };
+    return ordered_distance( ordered( x ), ordered( y ) );
+}
+
+static inline int64_t ulp( double x, double y )
+{
+    auto ordered = []( double v ) {
+        int64_t bits;
+        memcpy( &bits, &v, sizeof(bits) );
+        return bits >= 0 ? bits : INT64_MIN - bits;
+    };
+    return ordered_distance( ordered( x ), ordered( y ) );
+}
+
+template <typename T>
+static inline int64_t ulp( std::complex<T> x, std::complex<T> y )
+{
+    return std::max( ulp( x.real(), y.real() ), ulp( x.imag(), y.imag() ) );
+}
+
+static inline int64_t ulp( int64_t x, int64_t y )
+{
+    return ordered_distance( x, y );
+}
+
+/// @return true if x and y differ, including if either is NaN.
+static inline bool differ( Half x, Half y )
+{
+    double xd = to_double( x ), yd = to_double( y );
+    return ! (xd == yd);
+}
+
+template <typename T>
+static inline bool differ( T x, T y )
+{
+    return ! (x == y);
+}
+
+// -----------------------------------------------------------------------------
+/// Reduces differences of x and y in parallel. NaN differences are
+/// counted separately, since max reductions may drop NaN; if any,
+/// the errors are NaN, so they fail any tolerance.
+template <typename T>
+static Difference difference_impl( int64_t n, T const* x, T const* y )
+{
+    double max_abs = 0, max_rel = 0, ssq_diff = 0, ssq_y = 0;
+    int64_t max_ulp = 0, first = n, nans = 0;
+
+    #pragma omp parallel for simd schedule( static ) \
+        reduction( max: max_abs, max_rel, max_ulp ) \
+        reduction( +: ssq_diff, ssq_y, nans ) reduction( min: first )
+    for (int64_t i = 0; i < n; ++i) {
+        double d  = abs_diff( x[ i ], y[ i ] );
+        double ay = abs_val( y[ i ] );
+        if (std::isnan( d ) || std::isnan( ay )) {
+            nans += 1;
+            d  = 0;
+            ay = 0;
         }
-        // if "*", use Cartesian product
-        // if "x", use "inner" product
-        // if "*" or "x", scan N; else K = N = M
-        len = 0;
-        bool cartesian = false;
-        sscanf( str, " * %n", &len );
-        if (len > 0)
-            cartesian = true;
-        else
-            sscanf( str, " x %n", &len );
-        if (len > 0) {
-            str += len;
-            if (scan_range( &str, &n_start, &n_end, &n_step ) != 0) {
-                throw_error( "invalid n dimension at '%s', "
-                             "expected integer or range start:end:step", str );
-            }
-            // if "*" or "x", scan K; else K = N
-            len = 0;
-            if (cartesian)
-                sscanf( str, " * %n", &len );
-            else
-                sscanf( str, " x %n", &len );
-            if (len > 0) {
-                str += len;
-                if (scan_range( &str, &k_start, &k_end, &k_step ) != 0) {
-                    throw_error( "invalid k dimension at '%s', "
-                                 "expected integer or range start:end:step", str );
-                }
-            }
-            else {
-                k_start = n_start;
-                k_end   = n_end;
-                k_step  = n_step;
-            }
+        double rel = ay > 0 ? d / ay : d;
+        max_abs = std::max( max_abs, d );
+        max_rel = std::max( max_rel, rel );
+        ssq_diff += d * d;
+        ssq_y    += ay * ay;
+        max_ulp = std::max( max_ulp, ulp( x[ i ], y[ i ] ) );
+        if (differ( x[ i ], y[ i ] ))
+            first = std::min( first, i );
+    }
+
+    Difference diff;
+    diff.max_abs = max_abs;
+    diff.max_rel = max_rel;
+    diff.norm    = ssq_y > 0 ? sqrt( ssq_diff / ssq_y ) : sqrt( ssq_diff );
+    if (nans > 0) {
+        diff.max_abs = NAN;
+        diff.max_rel = NAN;
+        diff.norm    = NAN;
+    }
+    diff.max_ulp = max_ulp;
+    diff.first   = first < n ? first : -1;
+    return diff;
+}
+
+// -----------------------------------------------------------------------------
+/// Compares result x with reference y, element-wise, in parallel.
+/// Use with params.verify() to set error and okay outputs.
+///
+/// @param[in] n
+///     Number of elements.
+///
+/// @param[in] x
+///     Result to check, array of length n.
+///
+/// @param[in] y
+///     Reference result, array of length n.
+///
+/// @return max absolute and relative differences, norm-wise relative
+/// error, max ULP distance, and index of first mismatch.
+///
+Difference difference( int64_t n, float const* x, float const* y )
+{
+    return difference_impl( n, x, y );
+}
+
+/// @see difference( int64_t, float const*, float const* )
+Difference difference( int64_t n, double const* x, double const* y )
+{
+    return difference_impl( n, x, y );
+}
+
+/// @see difference( int64_t, float const*, float const* )
+Difference difference( int64_t n, std::complex<float> const* x,
+                       std::complex<float> const* y )
+{
+    return difference_impl( n, x, y );
+}
+
+/// @see difference( int64_t, float const*, float const* )
+Difference difference( int64_t n, std::complex<double> const* x,
+                       std::complex<double> const* y )
+{
+    return difference_impl( n, x, y );
+}
+
+/// @see difference( int64_t, float const*, float const* )
+Difference difference( int64_t n, int64_t const* x, int64_t const* y )
+{
+    return difference_impl( n, x, y );
+}
+
+/// Compares x and y of given type, with the same types as random_fill.
+/// @see difference( int64_t, float const*, float const* )
+Difference difference( DataType type, int64_t n,
+                       void const* x, void const* y )
+{
+    switch (type) {
+        case DataType::Integer:
+            return difference( n, (int64_t const*) x, (int64_t const*) y );
+        case DataType::Half:
+            return difference_impl( n, (Half const*) x, (Half const*) y );
+        case DataType::Single:
+            return difference( n, (float const*) x, (float const*) y );
+        case DataType::Double:
+            return difference( n, (double const*) x, (double const*) y );
+        case DataType::SingleComplex:
+            return difference( n, (std::complex<float> const*) x,
+                                  (std::complex<float> const*) y );
+        case DataType::DoubleComplex:
+            return difference( n, (std::complex<double> const*) x,
+                                  (std::complex<double> const*) y );
+    }
+    throw_error( "unknown datatype" );
+    return Difference();
+}
+
+// =============================================================================
+// ParamBase class
+
+// -----------------------------------------------------------------------------
+// if name has \n, for line=0, print 1st line; for line=1, print 2nd line.
+// otherwise,      for line=0, print blank;    for line=1, print name.
+// virtual
+void ParamBase::header( int line ) const
+{
+    if (used_ && width_ > 0) {
+        size_t i = name_.find( '\n' );
+        std::string str;
+        if (i != std::string::npos) {
+            str = (line == 0
+                ? name_.substr( 0, i ).c_str()
+                : name_.substr( i+1 ).c_str() );
         }
         else {
-            k_start = n_start = m_start;
-            k_end   = n_end   = m_end;
-            k_step  = n_step  = m_step;
+            str = (line == 0
+                ? ""
+                : name_.c_str() );
         }
+        printf( "%*s  ", width_, str.c_str() );
+    }
+}
 
-        if (m_start == m_end && n_start == n_end && k_start == k_end) {
-            // single size
-            int3_t dim = { m_start, n_start, k_start };
-            push_back( dim );
-        }
-        else if (cartesian) {
-            // Cartesian product of M x N x K
-            // require non-zero step
-            if (m_step == 0) m_step = 1;
-            if (n_step == 0) n_step = 1;
-            if (k_step == 0) k_step = 1;
-            for (int64_t m = m_start;
-                 (m_step >= 0 ? m <= m_end : m >= m_end);
-                 m += m_step) {
-
-                for (int64_t n = n_start;
-                     (n_step >= 0 ? n <= n_end : n >= n_end);
-                     n += n_step) {
-
-                    for (int64_t k = k_start;
-                         (k_step >= 0 ? k <= k_end : k >= k_end);
-                         k += k_step)
-                    {
-                        int3_t dim = { m, n, k };
-                        push_back( dim );
-                    }
-                }
-            }
+// -----------------------------------------------------------------------------
+// virtual
+void ParamBase::help() const
+{
+    if (type_ == ParamType::Value || type_ == ParamType::List) {
+        printf( "    %-16s %s\n", option_.c_str(), help_.c_str() );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+bool ParamBase::next()
+{
+    assert( index_ >= 0 && index_ < size() );
+    if (index_ == size() - 1) {
+        index_ = 0;
+        return false;
+    }
+    else {
+        index_ += 1;
+        return true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Gets numeric value of parameter at the current point,
+/// for evaluating expressions such as `--where` constraints.
+///
+/// @param[in] field
+///     Component of parameter, e.g., "m" for dim.m; empty for scalars.
+///
+/// @param[out] value
+///     Numeric value.
+///
+/// @param[out] is_int
+///     Whether value is an integer.
+///
+/// @return true if parameter has a numeric value for field;
+///         false otherwise, e.g., for strings. Default is false.
+// virtual
+bool ParamBase::number( std::string const&, double*, bool* ) const
+{
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+/// Sets numeric value of parameter at the current point,
+/// for derived parameters computed from an expression.
+///
+/// @param[in] value
+///     Numeric value.
+///
+/// @return true if value was set; false if parameter can't be set from
+///         a single number, e.g., strings. Default is false.
+// virtual
+bool ParamBase::number( double )
+{
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+/// Appends parameter's value at the current point to row,
+/// for sinks that collect results as data.
+/// Default appends number( "" ) if the parameter has a numeric value.
+///
+/// @param[in,out] row
+///     Values of columns at the current point.
+// virtual
+void ParamBase::values( std::vector< ParamValue >& row ) const
+{
+    double value;
+    bool is_int;
+    if (number( "", &value, &is_int ))
+        row.push_back( { option_.substr( 2 ), value, "" } );
+}
+
+// -----------------------------------------------------------------------------
+/// Invalidates owner's index of options, after the option name changed.
+void ParamBase::reindex()
+{
+    owner_->indexed_ = false;
+}
+
+// -----------------------------------------------------------------------------
+/// Registers with the ParamsBase object being constructed, if any:
+/// that of the innermost Registration or, for a subclass without one,
+/// the most recent unparsed object.
+void ParamBase::attach()
+{
+    auto reg = ParamsBase::Registration::s_current;
+    if (reg != nullptr && reg->params_ != nullptr)
+        reg->params_->add( this );
+    else if (ParamsBase::s_constructing != nullptr)
+        ParamsBase::s_constructing->add( this );
+}
+
+// -----------------------------------------------------------------------------
+/// Unregisters from owner, if any.
+void ParamBase::detach()
+{
+    if (owner_ != nullptr)
+        owner_->remove( this );
+}
+
+// =============================================================================
+// ParamInt class
+// Integer parameters
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamInt::parse( const char *str )
+{
+    std::vector< int64_t > values;
+    while (true) {
+        int64_t start, end, step;
+        double ratio;
+        if (scan_range( &str, &start, &end, &step, &ratio ) != 0) {
+            throw_error( "invalid argument at '%s',"
+                         " expected integer or range start:end:step", str );
         }
-        else {
-            // inner product of M x N x K
-            // at least one of the variables must advance
-            assert( m_step != 0 || n_step != 0 || k_step != 0 );
-            for (int64_t m = m_start,
-                         n = n_start,
-                         k = k_start;
-
-                 (m_step >= 0 ? m <= m_end : m >= m_end) &&
-                 (n_step >= 0 ? n <= n_end : n >= n_end) &&
-                 (k_step >= 0 ? k <= k_end : k >= k_end);
-
-                 m += m_step,
-                 n += n_step,
-                 k += k_step)
-            {
-                int3_t dim = { m, n, k };
-                push_back( dim );
-            }
+        values.clear();
+        append_range( values, start, end, step, ratio );
+        for (int64_t val : values) {
+            push_back( val );
         }
         if (*str == '\0') {
             break;
@@ -630,47 +1206,236 @@ void ParamInt3::parse( const char *str )
 }
 
 // -----------------------------------------------------------------------------
-void ParamInt3::push_back( int3_t val )
+void ParamInt::push_back( int64_t val )
 {
-    if (val.m < min_value_ || val.m > max_value_ ||
-        val.n < min_value_ || val.n > max_value_ ||
-        val.k < min_value_ || val.k > max_value_)
-    {
-        throw_error( "invalid value, %lld x %lld x %lld outside [%lld, %lld]",
-                     (long long) val.m,
-                     (long long) val.n,
-                     (long long) val.k,
+    if (val < min_value_ || val > max_value_) {
+        throw_error( "invalid argument, %lld outside [%lld, %lld]",
+                     (long long) val,
                      (long long) min_value_,
                      (long long) max_value_ );
     }
-    TParamBase<int3_t>::push_back( val );
+    TParamBase<int64_t>::push_back( val );
 }
 
 // -----------------------------------------------------------------------------
 // virtual
-void ParamInt3::print() const
+void ParamInt::print() const
 {
-    if (width_ > 0) {
-        if (used_ & m_mask) {
-            printf( "%*lld  ", width_, (long long) values_[ index_ ].m );
-        }
-        if (used_ & n_mask) {
-            printf( "%*lld  ", width_, (long long) values_[ index_ ].n );
-        }
-        if (used_ & k_mask) {
-            printf( "%*lld  ", width_, (long long) values_[ index_ ].k );
-        }
+    if (used_ && width_ > 0) {
+        printf( "%*lld  ", width_, (long long) values_[ index_ ] );
     }
 }
 
 // -----------------------------------------------------------------------------
-// for line=0, print blanks
-// for line=1, print whichever of m, n, k are used
 // virtual
-void ParamInt3::header( int line ) const
+void ParamInt::help() const
 {
-    if (width_ > 0) {
-        if (used_ & m_mask) {
+    if (type_ == ParamType::Value || type_ == ParamType::List) {
+        printf( "    %-16s %s; default %lld\n",
+                option_.c_str(), help_.c_str(), (long long) default_value_ );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+bool ParamInt::number( std::string const& field,
+                       double* value, bool* is_int ) const
+{
+    if (! field.empty())
+        return false;
+    *value  = values_[ index_ ];
+    *is_int = true;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Rounds value to nearest integer.
+// Throws error if value is outside [min, max].
+// virtual
+bool ParamInt::number( double value )
+{
+    int64_t val = llround( value );
+    if (val < min_value_ || val > max_value_) {
+        throw_error( "%s = %lld outside [%lld, %lld]",
+                     option_.c_str() + 2, (long long) val,
+                     (long long) min_value_,
+                     (long long) max_value_ );
+    }
+    values_[ index_ ] = val;
+    return true;
+}
+
+// =============================================================================
+// ParamOkay class
+// same as ParamInt, but prints pass (for non-zero) or FAILED (for zero).
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamOkay::print() const
+{
+    if (used_ && width_ > 0) {
+        const char *msg = "";
+        switch (values_[ index_ ]) {
+            case  0: msg = "FAILED";   break;
+            case  1: msg = "pass";     break;
+            case no_check: msg = "no check"; break;
+            case skipped:  msg = "skipped";  break;
+        }
+        printf( "%-*s  ", width_, msg );
+    }
+}
+
+// =============================================================================
+// ParamInt3 class
+// Integer 3-tuple parameters for M x N x K dimensions
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamInt3::parse( const char *str )
+{
+    // Each of m, n, k is expanded into a list of values,
+    // from an arithmetic or geometric range.
+    std::vector< int64_t > m_list, n_list, k_list;
+    int64_t start, end, step;
+    double ratio;
+    int len;
+    while (true) {
+        // scan M
+        if (scan_range( &str, &start, &end, &step, &ratio ) != 0) {
+            throw_error( "invalid m dimension at '%s', "
+                         "expected integer or range start:end:step", str );
+        }
+        m_list.clear();
+        append_range( m_list, start, end, step, ratio );
+
+        // if "*", use Cartesian product
+        // if "x", use "inner" product
+        // if "*" or "x", scan N; else K = N = M
+        len = 0;
+        bool cartesian = false;
+        sscanf( str, " * %n", &len );
+        if (len > 0)
+            cartesian = true;
+        else
+            sscanf( str, " x %n", &len );
+        if (len > 0) {
+            str += len;
+            if (scan_range( &str, &start, &end, &step, &ratio ) != 0) {
+                throw_error( "invalid n dimension at '%s', "
+                             "expected integer or range start:end:step", str );
+            }
+            n_list.clear();
+            append_range( n_list, start, end, step, ratio );
+
+            // if "*" or "x", scan K; else K = N
+            len = 0;
+            if (cartesian)
+                sscanf( str, " * %n", &len );
+            else
+                sscanf( str, " x %n", &len );
+            if (len > 0) {
+                str += len;
+                if (scan_range( &str, &start, &end, &step, &ratio ) != 0) {
+                    throw_error( "invalid k dimension at '%s', "
+                                 "expected integer or range start:end:step", str );
+                }
+                k_list.clear();
+                append_range( k_list, start, end, step, ratio );
+            }
+            else {
+                k_list = n_list;
+            }
+        }
+        else {
+            k_list = n_list = m_list;
+        }
+
+        if (m_list.size() == 1 && n_list.size() == 1 && k_list.size() == 1) {
+            // single size
+            int3_t dim = { m_list[0], n_list[0], k_list[0] };
+            push_back( dim );
+        }
+        else if (cartesian) {
+            // Cartesian product of M x N x K
+            for (int64_t m : m_list) {
+                for (int64_t n : n_list) {
+                    for (int64_t k : k_list) {
+                        int3_t dim = { m, n, k };
+                        push_back( dim );
+                    }
+                }
+            }
+        }
+        else {
+            // inner product of M x N x K
+            // a fixed dimension (single value) is repeated;
+            // stop at end of the shortest range.
+            size_t cnt = std::numeric_limits< size_t >::max();
+            for (auto list : { &m_list, &n_list, &k_list }) {
+                if (list->size() > 1)
+                    cnt = std::min( cnt, list->size() );
+            }
+            for (size_t i = 0; i < cnt; ++i) {
+                int3_t dim = {
+                    m_list[ m_list.size() > 1 ? i : 0 ],
+                    n_list[ n_list.size() > 1 ? i : 0 ],
+                    k_list[ k_list.size() > 1 ? i : 0 ]
+                };
+                push_back( dim );
+            }
+        }
+        if (*str == '\0') {
+            break;
+        }
+        if (*str != ',' && *str != ';') {
+            throw_error( "invalid argument at '%s', expected comma", str );
+        }
+        str += 1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void ParamInt3::push_back( int3_t val )
+{
+    if (val.m < min_value_ || val.m > max_value_ ||
+        val.n < min_value_ || val.n > max_value_ ||
+        val.k < min_value_ || val.k > max_value_)
+    {
+        throw_error( "invalid value, %lld x %lld x %lld outside [%lld, %lld]",
+                     (long long) val.m,
+                     (long long) val.n,
+                     (long long) val.k,
+                     (long long) min_value_,
+                     (long long) max_value_ );
+    }
+    TParamBase<int3_t>::push_back( val );
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamInt3::print() const
+{
+    if (width_ > 0) {
+        if (used_ & m_mask) {
+            printf( "%*lld  ", width_, (long long) values_[ index_ ].m );
+        }
+        if (used_ & n_mask) {
+            printf( "%*lld  ", width_, (long long) values_[ index_ ].n );
+        }
+        if (used_ & k_mask) {
+            printf( "%*lld  ", width_, (long long) values_[ index_ ].k );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// for line=0, print blanks
+// for line=1, print whichever of m, n, k are used
+// virtual
+void ParamInt3::header( int line ) const
+{
+    if (width_ > 0) {
+        if (used_ & m_mask) {
             printf( "%*s  ", width_, (line == 0 ? "" : m_name_.c_str()) );
         }
         if (used_ & n_mask) {
@@ -682,566 +1447,4268 @@ void ParamInt3::header( int line ) const
     }
 }
 
-// =============================================================================
-// ParamComplex class
 // -----------------------------------------------------------------------------
-// Scans single real or complex value and lists of values.
-//
-std::complex<double> ParamComplex::scan_complex( const char** str )
+// Components are "m", "n", "k", or names set by names(), e.g., "p", "q".
+// virtual
+bool ParamInt3::number( std::string const& field,
+                        double* value, bool* is_int ) const
+{
+    int3_t const& val = values_[ index_ ];
+    if (field == "m" || (field == m_name_ && ! field.empty()))
+        *value = val.m;
+    else if (field == "n" || (field == n_name_ && ! field.empty()))
+        *value = val.n;
+    else if (field == "k" || (field == k_name_ && ! field.empty()))
+        *value = val.k;
+    else
+        return false;
+    *is_int = true;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+/// Appends used fields, as name.m, name.n, name.k.
+// virtual
+void ParamInt3::values( std::vector< ParamValue >& row ) const
+{
+    std::string name = option_.substr( 2 );
+    int3_t const& val = values_[ index_ ];
+    if (used_ & m_mask)
+        row.push_back( { name + ".m", double( val.m ), "" } );
+    if (used_ & n_mask)
+        row.push_back( { name + ".n", double( val.n ), "" } );
+    if (used_ & k_mask)
+        row.push_back( { name + ".k", double( val.k ), "" } );
+}
+
+// =============================================================================
+// ParamComplex class
+// -----------------------------------------------------------------------------
+// Scans single real or complex value and lists of values.
+//
+std::complex<double> ParamComplex::scan_complex( const char** str )
+{
+    char op, suffix;
+    double x, y;
+    std::complex<double> value;
+    int cnt, bytes1, bytes2, bytes3;
+    cnt = sscanf( *str, "%lf %n %c %n %lf%c %n", &x, &bytes1, &op, &bytes2, &y, &suffix, &bytes3 );
+    if (cnt == 4 && (op == '+' || op == '-') && suffix == 'i') {
+        // x+yi or x-yi complex value
+        if (op == '+')
+            value = std::complex<double>( x, y );
+        else
+            value = std::complex<double>( x, -y );
+
+        *str += bytes3;
+    }
+    else if (cnt == 2 && op == 'i') {
+        // xi imaginary value
+        value = std::complex<double>( 0, x );
+        *str += bytes2;
+    }
+    else if (cnt == 1) {
+        // x real value
+        value = x;
+        *str += bytes1;
+    }
+    else if (cnt > 1 && op == ',') { //handles case of two real values "2.34,1.11", or real and img "2.34,1.11i"
+        // x real value
+        value = x;
+        *str += bytes2 - 1; //leave comma
+    }
+    else {
+        std::string err = std::string("invalid value '") + *str
+                        + "'; expected format like '1.2' or '1.2+3.4i'";
+        throw std::runtime_error( err );
+    }
+    return value;
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamComplex::parse( const char *str )
+{
+    //printf("ParamComplex::parse\n");
+    while (true) {
+        std::complex<double> val = scan_complex( &str );
+        TParamBase< std::complex<double> >::push_back( val );
+        if (*str == '\0') {
+            break;
+        }
+
+        if (*str != ',' && *str != ';') {
+            throw_error( "invalid argument at '%s', expected comma", str );
+        }
+        str += 1;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Output the entire field in a fixed width W,
+// different than the width passed here. W = 2*width + 3,
+// to account for initial -, [+-] between real & complex parts, and i at end.
+// For instance, print calls snprintf_value with width=4, precision=2,
+// and then prints the resulting string in a field width 11 (%-11s).
+//
+template <typename scalar_t>
+const char* snprintf_value(
+    char* buf, size_t buf_len, int width, int precision, scalar_t value)
+{
+    using real_t = real_type<scalar_t>;
+
+    real_t re = std::real( value );
+    real_t im = std::imag( value );
+    if (re == int(re) && im == int(im)) {
+        // exactly integer, print without digits after decimal point
+        if (im != 0) {
+            snprintf(buf, buf_len, "% *.0f%c%.0fi",
+                     width - precision, re,
+                     (im >= 0 ? '+' : '-'),
+                     std::abs(im));
+        }
+        else {
+            snprintf(buf, buf_len, "% *.0f%*s",
+                     width - precision, re, precision, "");
+        }
+    }
+    else {
+        // general case
+        if (im != 0) {
+            snprintf(buf, buf_len, "% *.*f%c%.*fi",
+                     width, precision, re,
+                     (im >= 0 ? '+' : '-'),
+                     precision, std::abs(im));
+        }
+        else {
+            snprintf(buf, buf_len, "% *.*f",
+                     width, precision, re);
+        }
+    }
+    return buf;
+}
+
+// -----------------------------------------------------------------------------
+/// If field has been used, prints the value.
+/// If value is set to no_data_flag, it prints "NA".
+/// The output width and precision are set in the constructor.
+// virtual
+void ParamComplex::print() const
+{
+    char buf[ 1000 ];
+    if (used_ && display_width_ > 0) {
+        if (same( no_data_flag, values_[ index_ ].real() )) {  //TODO: check also for imaginary?
+            printf( "%*s  ", display_width_, "NA" );
+        }
+        else {
+            snprintf_value( buf, sizeof(buf), display_width_, precision_,
+                            values_[ index_ ] );
+            printf( "%-*s  ", width_, buf);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamComplex::help() const
+{
+    if (type_ == ParamType::Value || type_ == ParamType::List) {
+        printf( "    %-16s %s; default ",
+                option_.c_str(), help_.c_str() );
+        if (same( no_data_flag, default_value_.real() )) {
+            printf( "NA\n" );
+        }
+        else {
+            char buf[ 1000 ];
+            snprintf_value( buf, sizeof(buf), display_width_, precision_,
+                            default_value_ );
+            printf( "%s\n", buf );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Components are "re" and "im"; a real value has no component.
+// virtual
+bool ParamComplex::number( std::string const& field,
+                           double* value, bool* is_int ) const
+{
+    std::complex<double> const& val = values_[ index_ ];
+    if (field == "re" || (field.empty() && val.imag() == 0))
+        *value = val.real();
+    else if (field == "im")
+        *value = val.imag();
+    else
+        return false;
+    *is_int = false;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+/// Appends real and imaginary parts, as name.re, name.im.
+// virtual
+void ParamComplex::values( std::vector< ParamValue >& row ) const
+{
+    std::string name = option_.substr( 2 );
+    std::complex<double> const& val = values_[ index_ ];
+    row.push_back( { name + ".re", val.real(), "" } );
+    row.push_back( { name + ".im", val.imag(), "" } );
+}
+
+// =============================================================================
+// ParamDouble class
+// Double precision parameter
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamDouble::parse( const char *str )
+{
+    std::vector< double > values;
+    while (true) {
+        double start = 0, end = 0, step = 0, ratio = 0;
+        if (scan_range( &str, &start, &end, &step, &ratio ) != 0) {
+            throw_error( "invalid argument at '%s', "
+                         "expected float or range start:end:step", str );
+        }
+        values.clear();
+        append_range( values, start, end, step, ratio );
+        for (double val : values) {
+            push_back( val );
+        }
+        if (*str == '\0') {
+            break;
+        }
+        if (*str != ',' && *str != ';') {
+            throw_error( "invalid argument at '%s', expected comma", str );
+        }
+        str += 1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void ParamDouble::push_back( double val )
+{
+    if (val < min_value_ || val > max_value_) {
+        throw_error( "invalid argument, %.*f outside [%.*f, %.*f]",
+                     precision_, val,
+                     precision_, min_value_,
+                     precision_, max_value_ );
+    }
+    TParamBase<double>::push_back( val );
+}
+
+// -----------------------------------------------------------------------------
+/// If field has been used, prints the floating point value.
+/// If value is set to no_data_flag, it prints "NA".
+/// If value < 1, it prints with precision (p) significant digits (%.pg).
+/// Otherwise, it prints with precision (p) digits after the decimal point (%.pf).
+/// The output width and precision are set in the constructor.
+// virtual
+void ParamDouble::print() const
+{
+    if (used_ && width_ > 0) {
+        if (same( no_data_flag, values_[ index_ ] )) {
+            printf( "%*s  ", width_, "NA" );
+        }
+        else {
+            if (std::abs( values_[ index_ ] ) < 1)
+                printf( "%#*.*g  ", width_, precision_, values_[ index_ ] );
+            else
+                printf( "%*.*f  ", width_, precision_, values_[ index_ ] );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamDouble::help() const
+{
+    if (type_ == ParamType::Value || type_ == ParamType::List) {
+        printf( "    %-16s %s; default ",
+                option_.c_str(), help_.c_str() );
+        if (same( no_data_flag, default_value_ )) {
+            printf( "NA\n" );
+        }
+        else {
+            printf( "%.*f\n", precision_, default_value_ );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+bool ParamDouble::number( std::string const& field,
+                          double* value, bool* is_int ) const
+{
+    if (! field.empty())
+        return false;
+    *value  = values_[ index_ ];
+    *is_int = false;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Throws error if value is outside [min, max].
+// virtual
+bool ParamDouble::number( double value )
+{
+    if (value < min_value_ || value > max_value_) {
+        throw_error( "%s = %.*f outside [%.*f, %.*f]",
+                     option_.c_str() + 2,
+                     precision_, value,
+                     precision_, min_value_,
+                     precision_, max_value_ );
+    }
+    values_[ index_ ] = value;
+    return true;
+}
+
+// =============================================================================
+// ParamScientific class
+// same as ParamDouble, but prints using scientific notation (%e)
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamScientific::print() const
+{
+    if (used_ && width_ > 0) {
+        if (same( no_data_flag, values_[ index_ ] )) {
+            printf( "%*s  ", width_, "NA" );
+        }
+        else {
+            printf( "%*.*e  ", width_, precision_, values_[ index_ ] );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamScientific::help() const
+{
+    if (type_ == ParamType::Value || type_ == ParamType::List) {
+        printf( "    %-16s %s; default ",
+                option_.c_str(), help_.c_str() );
+        if (same( no_data_flag, default_value_ )) {
+            printf( "NA\n" );
+        }
+        else {
+            printf( "%.*e\n", precision_, default_value_ );
+        }
+    }
+}
+
+// =============================================================================
+// ParamString class
+// String parameters
+
+// -----------------------------------------------------------------------------
+// Return true if str is in the list of valid strings.
+// If no valid strings are set, always returns true.
+bool ParamString::is_valid( const std::string& str )
+{
+    if (valid_.size() == 0)
+        return true;
+    for (auto iter = valid_.begin(); iter != valid_.end(); ++iter) {
+        if (str == *iter)
+            return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamString::parse( const char *str )
+{
+    char* copy = strdup( str );
+    char* token = strtok( copy, "," );
+    while (token != nullptr) {
+        push_back( token );
+        token = strtok( nullptr, "," );
+    }
+    free( copy );
+}
+
+// -----------------------------------------------------------------------------
+void ParamString::push_back( const char* str )
+{
+    if (! is_valid(str)) {
+        throw_error( "invalid argument '%s'", str );
+    }
+    TParamBase< std::string >::push_back( str );
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamString::print() const
+{
+    if (used_ && width_ > 0) {
+        printf( "%-*s  ", width_, values_[ index_ ].c_str() );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamString::values( std::vector< ParamValue >& row ) const
+{
+    row.push_back( { option_.substr( 2 ),
+                     std::numeric_limits<double>::quiet_NaN(),
+                     values_[ index_ ] } );
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamString::help() const
+{
+    if (type_ == ParamType::Value || type_ == ParamType::List) {
+        printf( "    %-16s %s; default '%s'",
+                option_.c_str(), help_.c_str(),
+                default_value_.c_str() );
+        if (valid_.size() > 0) {
+            printf( "; valid: " );
+            for (auto iter = valid_.begin(); iter != valid_.end(); ++iter) {
+                printf( "%s ", iter->c_str() );
+            }
+        }
+        printf( "\n" );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Set the allowed strings
+void ParamString::add_valid( const char* str )
+{
+    valid_.push_back( str );
+}
+
+// -----------------------------------------------------------------------------
+// for line=0, print blanks
+// for line=1, print name (left aligned)
+// virtual
+void ParamString::header( int line ) const
+{
+    if (used_ && width_ > 0) {
+        printf( "%-*s  ", width_, (line == 0 ? "" : name_.c_str()) );
+    }
+}
+
+// =============================================================================
+// ParamChar class
+// Character parameters
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamChar::parse( const char *str )
+{
+    while (true) {
+        char val;
+        int len;
+        int i = sscanf( str, "%c %n", &val, &len );
+        if (i != 1) {
+            throw_error( "invalid argument at '%s', expected one char", str );
+        }
+        str += len;
+        push_back( val );
+        if (*str == '\0') {
+            break;
+        }
+        if (*str != ',' && *str != ';') {
+            throw_error( "invalid argument at '%s', expected comma", str );
+        }
+        str += 1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void ParamChar::push_back( char val )
+{
+    if (valid_.find( val ) == std::string::npos) {  // not found
+        throw_error( "invalid option, %c not in [%s]", val, valid_.c_str() );
+    }
+    TParamBase<char>::push_back( val );
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamChar::print() const
+{
+    if (used_ && width_ > 0) {
+        printf( "%*c  ", width_, values_[ index_ ] );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamChar::help() const
+{
+    if (type_ == ParamType::Value || type_ == ParamType::List) {
+        printf( "    %-16s %s; default %c; valid: [%s]\n",
+                option_.c_str(), help_.c_str(),
+                default_value_, valid_.c_str() );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Value is the character code, to compare with character literals, e.g., 'y'.
+// virtual
+bool ParamChar::number( std::string const& field,
+                        double* value, bool* is_int ) const
+{
+    if (! field.empty())
+        return false;
+    *value  = values_[ index_ ];
+    *is_int = true;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+void ParamChar::values( std::vector< ParamValue >& row ) const
+{
+    char val = values_[ index_ ];
+    row.push_back( { option_.substr( 2 ), double( val ),
+                     std::string( 1, val ) } );
+}
+
+// =============================================================================
+// Expression class
+// Expressions over parameters, for --where constraints.
+
+// -----------------------------------------------------------------------------
+/// Compiles expression into postfix program.
+/// Throws std::runtime_error for syntax errors or unknown parameters.
+///
+/// @param[in] str
+///     Expression, e.g., "dim.m >= dim.n && nb <= min( dim.m, dim.n )".
+///
+/// @param[in] params
+///     Parameters that names in expression refer to.
+///
+Expression::Expression( const char* str, ParamsBase const& params ):
+    str_( str ),
+    pos_( str ),
+    params_( &params )
+{
+    compile_or();
+    while (isspace( *pos_ ))
+        ++pos_;
+    if (*pos_ != '\0')
+        throw_error( "invalid expression at '%s'", pos_ );
+
+    // Check that stack is balanced and get max depth for eval.
+    int depth = 0, max_depth = 0;
+    for (auto& op : ops_) {
+        switch (op.code) {
+            case OpCode::Const:
+            case OpCode::Param:
+                depth += 1;
+                break;
+            case OpCode::Neg:
+            case OpCode::Not:
+                break;
+            default:
+                // binary operators and functions pop nargs, push 1
+                depth -= (op.nargs > 0 ? op.nargs : 2) - 1;
+                break;
+        }
+        max_depth = std::max( max_depth, depth );
+    }
+    assert( depth == 1 );
+    stack_.resize( max_depth );
+    pos_ = nullptr;
+    params_ = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+/// If the next token in expression is token, skips it and returns true;
+/// otherwise returns false.
+bool Expression::match( const char* token )
+{
+    while (isspace( *pos_ ))
+        ++pos_;
+    size_t len = strlen( token );
+    if (strncmp( pos_, token, len ) == 0) {
+        // Don't match "<" in "<=", "=" in "==", "&" in "&&", etc.
+        if (len == 1 && strchr( "<>!=", token[0] ) && pos_[1] == '=')
+            return false;
+        pos_ += len;
+        return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+void Expression::emit( OpCode code, int nargs )
+{
+    Op op {};
+    op.code  = code;
+    op.nargs = nargs;
+    ops_.push_back( op );
+}
+
+// -----------------------------------------------------------------------------
+// or := and ( || and )*
+void Expression::compile_or()
+{
+    compile_and();
+    while (match( "||" )) {
+        compile_and();
+        emit( OpCode::Or );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// and := equal ( && equal )*
+void Expression::compile_and()
+{
+    compile_equal();
+    while (match( "&&" )) {
+        compile_equal();
+        emit( OpCode::And );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// equal := compare ( (== | !=) compare )*
+void Expression::compile_equal()
+{
+    compile_compare();
+    while (true) {
+        OpCode code;
+        if      (match( "==" )) code = OpCode::Eq;
+        else if (match( "!=" )) code = OpCode::Ne;
+        else break;
+        compile_compare();
+        emit( code );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// compare := add ( (< | <= | > | >=) add )*
+void Expression::compile_compare()
+{
+    compile_add();
+    while (true) {
+        OpCode code;
+        if      (match( "<=" )) code = OpCode::Le;
+        else if (match( ">=" )) code = OpCode::Ge;
+        else if (match( "<"  )) code = OpCode::Lt;
+        else if (match( ">"  )) code = OpCode::Gt;
+        else break;
+        compile_add();
+        emit( code );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// add := mul ( (+ | -) mul )*
+void Expression::compile_add()
+{
+    compile_mul();
+    while (true) {
+        OpCode code;
+        if      (match( "+" )) code = OpCode::Add;
+        else if (match( "-" )) code = OpCode::Sub;
+        else break;
+        compile_mul();
+        emit( code );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// mul := unary ( (* | / | %) unary )*
+void Expression::compile_mul()
+{
+    compile_unary();
+    while (true) {
+        OpCode code;
+        if      (match( "*" )) code = OpCode::Mul;
+        else if (match( "/" )) code = OpCode::Div;
+        else if (match( "%" )) code = OpCode::Mod;
+        else break;
+        compile_unary();
+        emit( code );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// unary := (- | + | !) unary | primary
+void Expression::compile_unary()
+{
+    if (match( "-" )) {
+        compile_unary();
+        emit( OpCode::Neg );
+    }
+    else if (match( "+" )) {
+        compile_unary();
+    }
+    else if (match( "!" )) {
+        compile_unary();
+        emit( OpCode::Not );
+    }
+    else {
+        compile_primary();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// primary := number | 'c' | name [. field] | function( args ) | ( or )
+void Expression::compile_primary()
+{
+    while (isspace( *pos_ ))
+        ++pos_;
+
+    if (match( "(" )) {
+        compile_or();
+        if (! match( ")" ))
+            throw_error( "expected ')' at '%s'", pos_ );
+    }
+    else if (isdigit( *pos_ ) || *pos_ == '.') {
+        // Number. Integers can have metric or binary prefix, e.g., 1k.
+        Op op {};
+        op.code = OpCode::Const;
+        char* end;
+        long long ival = strtoll( pos_, &end, 10 );
+        if (*end == '.' || *end == 'e' || *end == 'E') {
+            op.value = strtod( pos_, &end );
+            // Treat 1e3 as integer, as in ParamInt, but not 1.5 or 1.5e3.
+            std::string num( pos_, (const char*) end );
+            op.is_int = (num.find( '.' ) == std::string::npos
+                         && op.value == int64_t( op.value ));
+            pos_ = end;
+        }
+        else {
+            pos_ = end;
+            op.value  = ival * scan_multiplier( &pos_ );
+            op.is_int = true;
+        }
+        ops_.push_back( op );
+    }
+    else if (*pos_ == '\'') {
+        // Character literal, e.g., 'y'.
+        if (pos_[1] == '\0' || pos_[2] != '\'')
+            throw_error( "invalid character literal at '%s'", pos_ );
+        Op op {};
+        op.code   = OpCode::Const;
+        op.value  = pos_[1];
+        op.is_int = true;
+        ops_.push_back( op );
+        pos_ += 3;
+    }
+    else if (isalpha( *pos_ ) || *pos_ == '_') {
+        // Name of parameter or function.
+        const char* begin = pos_;
+        while (isalnum( *pos_ ) || *pos_ == '_')
+            ++pos_;
+        std::string name( begin, pos_ );
+
+        if (match( "(" )) {
+            // function( args )
+            static const struct {
+                const char* name;
+                OpCode code;
+                int min_args, max_args;
+            } functions[] = {
+                { "min",     OpCode::Min,     1, 1000 },
+                { "max",     OpCode::Max,     1, 1000 },
+                { "clamp",   OpCode::Clamp,   3, 3 },
+                { "abs",     OpCode::Abs,     1, 1 },
+                { "ceildiv", OpCode::Ceildiv, 2, 2 },
+                { "roundup", OpCode::Roundup, 2, 2 },
+                { "log2",    OpCode::Log2,    1, 1 },
+                { "sqrt",    OpCode::Sqrt,    1, 1 },
+                { "floor",   OpCode::Floor,   1, 1 },
+                { "ceil",    OpCode::Ceil,    1, 1 },
+            };
+            int nargs = 0;
+            if (! match( ")" )) {
+                do {
+                    compile_or();
+                    nargs += 1;
+                } while (match( "," ));
+                if (! match( ")" ))
+                    throw_error( "expected ')' at '%s'", pos_ );
+            }
+            for (auto& func : functions) {
+                if (name == func.name) {
+                    if (nargs < func.min_args || nargs > func.max_args) {
+                        throw_error( "wrong number of arguments to %s",
+                                     name.c_str() );
+                    }
+                    emit( func.code, nargs );
+                    return;
+                }
+            }
+            throw_error( "unknown function '%s'", name.c_str() );
+        }
+        else {
+            // parameter [. field]
+            std::string field;
+            if (*pos_ == '.') {
+                begin = ++pos_;
+                while (isalnum( *pos_ ) || *pos_ == '_')
+                    ++pos_;
+                field = std::string( begin, pos_ );
+            }
+            Op op {};
+            op.code  = OpCode::Param;
+            op.param = params_->find( name );
+            op.field = field;
+            if (op.param == nullptr) {
+                throw_error( "unknown parameter '%s' in expression",
+                             name.c_str() );
+            }
+            double value;
+            bool is_int;
+            if (! op.param->number( field, &value, &is_int )) {
+                std::string full = name + (field.empty() ? "" : ".") + field;
+                throw_error( "parameter '%s' is not numeric", full.c_str() );
+            }
+            ops_.push_back( op );
+        }
+    }
+    else {
+        throw_error( "invalid expression at '%s'", pos_ );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Evaluates expression using parameter values at the current point.
+/// Comparisons and logical operators return 1 for true, 0 for false.
+///
+/// @return value of expression.
+///
+double Expression::eval() const
+{
+    Value* stack = stack_.data();
+    int top = -1;
+    for (auto const& op : ops_) {
+        switch (op.code) {
+            case OpCode::Const:
+                stack[ ++top ] = { op.value, op.is_int };
+                break;
+
+            case OpCode::Param: {
+                Value val;
+                op.param->number( op.field, &val.value, &val.is_int );
+                stack[ ++top ] = val;
+                break;
+            }
+
+            case OpCode::Neg:
+                stack[ top ].value = -stack[ top ].value;
+                break;
+
+            case OpCode::Not:
+                stack[ top ] = { double( stack[ top ].value == 0 ), true };
+                break;
+
+            case OpCode::Min:
+            case OpCode::Max:
+            case OpCode::Clamp:
+            case OpCode::Abs:
+            case OpCode::Ceildiv:
+            case OpCode::Roundup:
+            case OpCode::Log2:
+            case OpCode::Sqrt:
+            case OpCode::Floor:
+            case OpCode::Ceil: {
+                Value* args = &stack[ top - op.nargs + 1 ];
+                top -= op.nargs - 1;
+                bool is_int = true;
+                for (int i = 0; i < op.nargs; ++i)
+                    is_int = is_int && args[ i ].is_int;
+                double x = args[ 0 ].value;
+                switch (op.code) {
+                    case OpCode::Min:
+                        for (int i = 1; i < op.nargs; ++i)
+                            x = std::min( x, args[ i ].value );
+                        break;
+                    case OpCode::Max:
+                        for (int i = 1; i < op.nargs; ++i)
+                            x = std::max( x, args[ i ].value );
+                        break;
+                    case OpCode::Clamp:
+                        x = std::max( args[ 1 ].value,
+                                      std::min( x, args[ 2 ].value ) );
+                        break;
+                    case OpCode::Abs:
+                        x = std::abs( x );
+                        break;
+                    case OpCode::Ceildiv:
+                        x = std::ceil( x / args[ 1 ].value );
+                        is_int = true;
+                        break;
+                    case OpCode::Roundup:
+                        x = std::ceil( x / args[ 1 ].value ) * args[ 1 ].value;
+                        break;
+                    case OpCode::Log2:
+                        x = std::log2( x );
+                        is_int = false;
+                        break;
+                    case OpCode::Sqrt:
+                        x = std::sqrt( x );
+                        is_int = false;
+                        break;
+                    case OpCode::Floor:
+                        x = std::floor( x );
+                        is_int = true;
+                        break;
+                    case OpCode::Ceil:
+                        x = std::ceil( x );
+                        is_int = true;
+                        break;
+                    default:
+                        break;
+                }
+                args[ 0 ] = { x, is_int };
+                break;
+            }
+
+            default: {
+                // binary operators
+                Value  b = stack[ top-- ];
+                Value& a = stack[ top ];
+                bool is_int = a.is_int && b.is_int;
+                double x = a.value, y = b.value, z = 0;
+                switch (op.code) {
+                    case OpCode::Mul: z = x * y; break;
+                    case OpCode::Add: z = x + y; break;
+                    case OpCode::Sub: z = x - y; break;
+                    case OpCode::Div:
+                        if (is_int) {
+                            if (y == 0)
+                                throw_error( "division by zero in '%s'",
+                                             str_.c_str() );
+                            z = double( int64_t( x ) / int64_t( y ) );
+                        }
+                        else {
+                            z = x / y;
+                        }
+                        break;
+                    case OpCode::Mod:
+                        if (is_int) {
+                            if (y == 0)
+                                throw_error( "division by zero in '%s'",
+                                             str_.c_str() );
+                            z = double( int64_t( x ) % int64_t( y ) );
+                        }
+                        else {
+                            z = std::fmod( x, y );
+                        }
+                        break;
+                    case OpCode::Lt:  z = x <  y; is_int = true; break;
+                    case OpCode::Le:  z = x <= y; is_int = true; break;
+                    case OpCode::Gt:  z = x >  y; is_int = true; break;
+                    case OpCode::Ge:  z = x >= y; is_int = true; break;
+                    case OpCode::Eq:  z = x == y; is_int = true; break;
+                    case OpCode::Ne:  z = x != y; is_int = true; break;
+                    case OpCode::And: z = x != 0 && y != 0; is_int = true; break;
+                    case OpCode::Or:  z = x != 0 || y != 0; is_int = true; break;
+                    default:
+                        break;
+                }
+                a = { z, is_int };
+                break;
+            }
+        }
+    }
+    assert( top == 0 );
+    return stack[ 0 ].value;
+}
+
+// =============================================================================
+// ParamsBase class
+// List of parameters
+
+// -----------------------------------------------------------------------------
+/// Starts registering parameters constructed on this thread, once a
+/// ParamsBase object is constructed.
+ParamsBase::Registration::Registration():
+    prev_( s_current )
+{
+    s_current = this;
+}
+
+// -----------------------------------------------------------------------------
+/// Stops registering parameters with this registration's object,
+/// resuming any enclosing registration.
+ParamsBase::Registration::~Registration()
+{
+    s_current = prev_;
+}
+
+// -----------------------------------------------------------------------------
+/// Constructs empty set of parameters. While the innermost Registration on
+/// this thread exists, parameters constructed on this thread are registered
+/// with this object, which is how members of a Params subclass get
+/// registered. Enclosing registrations without an object, e.g., of a
+/// subclass of Params, are also bound to this object.
+/// Without a Registration, parameters are registered with this object
+/// until it is parsed, for compatibility.
+ParamsBase::ParamsBase()
+{
+    bool registered = false;
+    for (auto reg = Registration::s_current;
+         reg != nullptr && reg->params_ == nullptr;
+         reg = reg->prev_)
+    {
+        reg->params_ = this;
+        registered = true;
+    }
+    s_constructing = registered ? nullptr : this;
+
+    // CPU affinity and number of threads, restored by unbind()
+#ifdef __linux__
+    cpu_set_t mask;
+    CPU_ZERO( &mask );
+    if (sched_getaffinity( 0, sizeof(mask), &mask ) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET( cpu, &mask ))
+                bind_allowed_.push_back( cpu );
+        }
+    }
+#endif
+#ifdef _OPENMP
+    threads_default_ = omp_get_max_threads();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+ParamsBase::~ParamsBase()
+{
+    // Members of subclass are already destroyed; detach any other params.
+    for (auto param : params_) {
+        param->owner_ = nullptr;
+    }
+    // If subclass constructor threw, its registration may still exist.
+    for (auto reg = Registration::s_current; reg != nullptr; reg = reg->prev_) {
+        if (reg->params_ == this)
+            reg->params_ = nullptr;
+    }
+    if (s_constructing == this)
+        s_constructing = nullptr;
+    ref_release();
+}
+
+// -----------------------------------------------------------------------------
+/// Registers parameter with this object, removing it from its
+/// previous owner, if any. Parameters are iterated and printed
+/// in order of registration.
+void ParamsBase::add( ParamBase* param )
+{
+    if (param->owner_ == this)
+        return;
+    if (param->owner_ != nullptr)
+        param->owner_->remove( param );
+    params_.push_back( param );
+    param->owner_ = this;
+    compiled_ = false;
+    indexed_ = false;
+}
+
+// -----------------------------------------------------------------------------
+/// Unregisters parameter from this object.
+/// Parameters are usually destroyed in reverse order of registration,
+/// so this is O(1) in the usual case.
+void ParamsBase::remove( ParamBase* param )
+{
+    if (! params_.empty() && params_.back() == param) {
+        params_.pop_back();
+    }
+    else {
+        auto iter = std::find( params_.begin(), params_.end(), param );
+        if (iter != params_.end())
+            params_.erase( iter );
+    }
+    param->owner_ = nullptr;
+    compiled_ = false;
+    indexed_ = false;
+}
+
+// -----------------------------------------------------------------------------
+/// If args[ *i ] is option, as either "--option value" (two args) or
+/// "--option=value" (one arg), returns its value and advances *i past it;
+/// otherwise returns null.
+///
+static const char* option_value(
+    const char* option, int n, char** args, int* i )
+{
+    const char* arg = args[ *i ];
+    size_t len = strlen( option );
+    if (strncmp( arg, option, len ) != 0)
+        return nullptr;
+    if (arg[ len ] == '=')
+        return arg + len + 1;
+    if (arg[ len ] != '\0')
+        return nullptr;
+    if (*i + 1 >= n)
+        throw_error( "requires an argument" );
+    *i += 1;
+    return args[ *i ];
+}
+
+// -----------------------------------------------------------------------------
+/// Throws QuitException if --help is encountered.
+/// Throws std::runtime_error for errors.
+void ParamsBase::parse( const char *routine, int n, char **args )
+{
+    routine_ = routine;
+    if (s_constructing == this)
+        s_constructing = nullptr;
+
+    // --threads and --mem-policy are applied by the framework, so are
+    // accepted even if routine doesn't use them; see parse_threads()
+    // and parse_mem_policy().
+    threads_param_ = find( "threads" );
+    if (threads_param_ != nullptr)
+        threads_param_->used( true );
+    mem_policy_param_
+        = dynamic_cast< TParamBase< MemPolicy >* >( find( "mem-policy" ) );
+    if (mem_policy_param_ != nullptr)
+        mem_policy_param_->used( true );
+
+    std::vector< const char* > where_str;
+    std::vector< std::pair< ParamBase*, const char* > > derived_str;
+    const char* tune_str      = nullptr;
+    const char* objective_str = nullptr;
+    const char* strategy_str  = nullptr;
+    bool maximize = true;
+
+    // Usage: test [params] command
+    for (int i = 0; i < n; ++i) {
+        const char *arg = args[i];
+        size_t len = strlen( arg );
+        try {
+            if (strncmp( arg, "-h", 2 ) == 0 ||
+                strncmp( arg, "--help", 6 ) == 0)
+            {
+                throw QuitException();
+            }
+            // framework options, handled after all parameters parsed
+            if (const char* value = option_value( "--where", n, args, &i )) {
+                where_str.push_back( value );
+                continue;
+            }
+            if (const char* value = option_value( "--tune", n, args, &i )) {
+                tune_str = value;
+                continue;
+            }
+            if (const char* value = option_value( "--maximize", n, args, &i )) {
+                objective_str = value;
+                maximize = true;
+                continue;
+            }
+            if (const char* value = option_value( "--minimize", n, args, &i )) {
+                objective_str = value;
+                maximize = false;
+                continue;
+            }
+            if (const char* value = option_value( "--tune-strategy",
+                                                  n, args, &i )) {
+                strategy_str = value;
+                continue;
+            }
+            if (strcmp( arg, "--isolate" ) == 0
+                || strncmp( arg, "--isolate=", 10 ) == 0)
+            {
+                // optional number of points per child process
+                const char* value = nullptr;
+                if (arg[ 9 ] == '=')
+                    value = arg + 10;
+                else if (i+1 < n && isdigit( args[ i+1 ][ 0 ] ))
+                    value = args[ ++i ];
+                isolate_ = 1;
+                if (value != nullptr) {
+                    char* end;
+                    isolate_ = strtol( value, &end, 10 );
+                    if (*end != '\0' || isolate_ < 1)
+                        throw_error( "invalid number of points '%s'", value );
+                }
+                continue;
+            }
+            if (strcmp( arg, "--noise" ) == 0) {
+                noise_ = true;
+                continue;
+            }
+            if (strcmp( arg, "--energy" ) == 0) {
+                energy_ = true;
+                continue;
+            }
+            if (const char* value = option_value( "--energy-root", n, args, &i )) {
+                energy_root_ = value;
+                continue;
+            }
+            if (strcmp( arg, "--alloc" ) == 0) {
+                alloc_ = true;
+                continue;
+            }
+            if (const char* value = option_value( "--align", n, args, &i )) {
+                char* end;
+                long long align = strtoll( value, &end, 10 );
+                if (*end != '\0' || align < 1)
+                    throw_error( "invalid alignment '%s'", value );
+                workspace_.alignment( align );
+                continue;
+            }
+            if (const char* value = option_value( "--seed", n, args, &i )) {
+                char* end;
+                seed_ = strtoull( value, &end, 10 );
+                if (*end != '\0' || *value == '-')
+                    throw_error( "invalid seed '%s'", value );
+                continue;
+            }
+            if (const char* value = option_value( "--ref-cache", n, args, &i )) {
+                ref_cache_dir_ = value;
+                continue;
+            }
+            if (strcmp( arg, "--huge-pages" ) == 0) {
+                workspace_.huge_pages( true );
+                continue;
+            }
+            if (strcmp( arg, "--prefault" ) == 0) {
+                workspace_.prefault( true );
+                continue;
+            }
+            if (strcmp( arg, "--poison" ) == 0) {
+                workspace_.poison( true );
+                continue;
+            }
+            if (const char* value = option_value( "--bind", n, args, &i )) {
+                bind_ = value;
+                continue;
+            }
+            if (const char* value = option_value( "--workers", n, args, &i )) {
+                char* end;
+                workers_ = strtol( value, &end, 10 );
+                if (*end != '\0' || workers_ < 1)
+                    throw_error( "invalid number of workers '%s'", value );
+                continue;
+            }
+            if (const char* value = option_value( "--tune-db", n, args, &i )) {
+                tune_db_file_ = value;
+                tune_db_loaded_ = false;
+                continue;
+            }
+            // handles both "--option value" (two arg)
+            // and          "--option=value" (one arg)
+            const char* eq = strchr( arg, '=' );
+            size_t plen = (eq ? size_t( eq - arg ) : len);
+            ParamBase* param = find_option( arg, plen );
+            if (param == nullptr) {
+                throw_error( "invalid parameter" );
+            }
+            if (! param->used()) {
+                throw_error( "invalid parameter for routine '%s'",
+                             routine );
+            }
+            const char *value = nullptr;
+            if (len == plen && i+1 < n) {
+                // --arg value (two arguments)
+                i += 1;
+                value = args[i];
+            }
+            else if (len > plen+1) {
+                // --arg=value (one argument)
+                value = arg + plen + 1;
+            }
+            else {
+                throw_error( "requires an argument" );
+            }
+            if (value[0] == '=') {
+                // derived parameter, compiled after all parameters
+                derived_str.push_back( { param, value + 1 } );
+            }
+            else if (strcmp( value, "tuned" ) == 0) {
+                // value from tuning database at each point
+                double default_value;
+                bool is_int;
+                if (param->size() != 1
+                    || ! param->number( "", &default_value, &is_int )
+                    || ! param->number( default_value ))
+                {
+                    throw_error( "parameter can't be tuned" );
+                }
+                tuned_.push_back( { param, default_value } );
+            }
+            else {
+                param->parse( value );
+            }
+        }
+        // QuitException is not a runtime_error,
+        // so it is caught at a higher level.
+        catch (const std::runtime_error& ex) {
+            // prepend arg to error message
+            throw std::runtime_error( std::string(arg) + ": " + ex.what() );
+        }
+    }
+
+    // Compile derived parameters and constraints,
+    // and skip to first point that satisfies constraints.
+    for (auto& item : derived_str) {
+        ParamBase* param = item.first;
+        try {
+            double value;
+            bool is_int;
+            if (param->size() != 1
+                || ! param->number( "", &value, &is_int )
+                || ! param->number( value ))
+            {
+                throw_error( "parameter can't be derived from an expression" );
+            }
+            derived_.push_back( { param, Expression( item.second, *this ) } );
+        }
+        catch (const std::runtime_error& ex) {
+            throw std::runtime_error( param->option_ + ": " + ex.what() );
+        }
+    }
+    for (auto str : where_str) {
+        try {
+            where_.push_back( Expression( str, *this ) );
+        }
+        catch (const std::runtime_error& ex) {
+            throw std::runtime_error( std::string("--where: ") + ex.what() );
+        }
+    }
+    parse_threads();
+    parse_mem_policy();
+    parse_noise();
+    parse_energy();
+    parse_alloc();
+    compile();
+    if (tune_str || objective_str || strategy_str) {
+        parse_tune( tune_str, objective_str, maximize, strategy_str );
+    }
+    if (! tuned_.empty() && tune_db_file_.empty())
+        throw_error( "--param tuned requires --tune-db" );
+    if (! tuned_.empty() && ! tune_db_loaded_) {
+        tune_db_.load( tune_db_file_ );
+        tune_db_loaded_ = true;
+    }
+    if (! bind_.empty()) {
+        // check CPUs now; binding is applied by apply(), when the sweep runs
+        (void) bind_cpus( 0, std::max( workers_, 1 ) );
+    }
+    // tune_sweep seeks its own points, counting rejected ones there
+    if (tune_param_ == nullptr && ! admit()) {
+        empty_ = ! next();
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Sets tuning state from `--tune`, `--maximize` or `--minimize`,
+/// and `--tune-strategy` options; arguments are null if not given.
+void ParamsBase::parse_tune(
+    const char* tune, const char* objective, bool maximize,
+    const char* strategy )
+{
+    if (tune == nullptr)
+        throw_error( "--maximize, --minimize, and --tune-strategy"
+                     " require --tune" );
+    if (isolate_ > 0 || workers_ > 0)
+        throw_error( "--tune can't be used with --isolate or --workers" );
+
+    tune_param_ = find( tune );
+    if (tune_param_ == nullptr || ! tune_param_->used()
+        || tune_param_->type_ == ParamType::Output)
+    {
+        throw_error( "--tune: unknown parameter '%s'", tune );
+    }
+    if (tune_param_->size() < 2)
+        throw_error( "--tune: parameter '%s' requires a list of values", tune );
+    for (auto const& item : derived_) {
+        if (item.param == tune_param_)
+            throw_error( "--tune: can't tune derived parameter '%s'", tune );
+    }
+
+    if (objective == nullptr)
+        objective = "gflops";
+    tune_output_ = find_output( objective );
+    double value;
+    bool is_int;
+    if (tune_output_ == nullptr || ! tune_output_->used()
+        || tune_output_->type_ != ParamType::Output
+        || ! tune_output_->number( "", &value, &is_int ))
+    {
+        throw_error( "--%s: unknown output '%s'",
+                     maximize ? "maximize" : "minimize", objective );
+    }
+    tune_maximize_ = maximize;
+
+    if (strategy == nullptr || strcmp( strategy, "grid" ) == 0)
+        tune_strategy_ = TuneStrategy::Grid;
+    else if (strcmp( strategy, "golden" ) == 0)
+        tune_strategy_ = TuneStrategy::Golden;
+    else if (strcmp( strategy, "halving" ) == 0)
+        tune_strategy_ = TuneStrategy::Halving;
+    else
+        throw_error( "--tune-strategy: unknown strategy '%s';"
+                     " use grid, golden, or halving", strategy );
+}
+
+// -----------------------------------------------------------------------------
+/// Sets thread scaling state from `--threads`, if the application has a
+/// threads parameter. Its column is shown only if given.
+/// If it has multiple values, the speedup and efficiency outputs, if the
+/// application has them, are computed relative to the smallest value;
+/// see scaling().
+void ParamsBase::parse_threads()
+{
+    speedup_param_    = nullptr;
+    efficiency_param_ = nullptr;
+    if (threads_param_ == nullptr)
+        return;
+
+    threads_param_->used( ! threads_param_->is_default_ );
+
+    // smallest thread count, as baseline
+    size_t size = threads_param_->size();
+    threads_min_ = std::numeric_limits< double >::infinity();
+    for (size_t i = 0; i < size; ++i) {
+        double value;
+        bool is_int;
+        threads_param_->index_ = i;
+        threads_param_->number( "", &value, &is_int );
+        if (size > 1 && value < 1)
+            throw_error( "--threads: number of threads must be positive" );
+    #ifndef _OPENMP
+        if (value > 1)
+            throw_error( "--threads: requires OpenMP" );
+    #endif
+        threads_min_ = std::min( threads_min_, value );
+    }
+    threads_param_->index_ = 0;
+
+    // outputs that are set by the framework
+    auto output = [size]( ParamBase* found ) {
+        if (found != nullptr)
+            found->used( size > 1 );
+        return size > 1 ? dynamic_cast< TParamBase< double >* >( found )
+                        : nullptr;
+    };
+    speedup_param_    = output( find_output( "speedup" ) );
+    efficiency_param_ = output( find_output( "efficiency" ) );
+}
+
+// -----------------------------------------------------------------------------
+/// Sets number of OpenMP threads for the current point, from `--threads`,
+/// before running it. Changing it re-applies `--bind`, if applied, since
+/// new threads inherit the binding of the main thread. 0, the default,
+/// restores the number of threads when params was constructed, if an
+/// earlier sweep changed it.
+void ParamsBase::apply_threads()
+{
+    int nthreads = 0;
+    if (threads_param_ != nullptr && threads_param_->used()) {
+        double value;
+        bool is_int;
+        threads_param_->number( "", &value, &is_int );
+        nthreads = int( value );
+    }
+    if (nthreads < 0 || nthreads == threads_current_)
+        return;
+
+    #ifdef _OPENMP
+    omp_set_num_threads( nthreads > 0 ? nthreads : threads_default_ );
+    #endif
+    threads_current_ = nthreads;
+    if (bound_)
+        bind( bind_worker_, bind_nworkers_ );
+}
+
+// -----------------------------------------------------------------------------
+/// Sets memory policy, if the application has a mem-policy parameter.
+/// Its column is shown only if given.
+/// Remote placement requires another NUMA node with memory.
+void ParamsBase::parse_mem_policy()
+{
+    if (mem_policy_param_ == nullptr)
+        return;
+
+    ParamBase* param = mem_policy_param_;
+    for (size_t i = 0; i < param->size(); ++i) {
+        param->index_ = i;
+        MemPolicy policy = (*mem_policy_param_)();
+    #ifndef __linux__
+        if (policy != MemPolicy::Default)
+            throw_error( "--mem-policy is supported only on Linux" );
+    #endif
+        if (policy == MemPolicy::Remote) {
+            // checks that there is a remote node; see mem_placement
+            (void) testsweeper::mem_placement( policy );
+        }
+    }
+    param->index_ = 0;
+
+    // after getting values, which marks it used
+    param->used( ! param->is_default_ );
+}
+
+// -----------------------------------------------------------------------------
+/// Sets memory policy for the current point, from `--mem-policy`,
+/// before running it. The node mask is computed only when the policy
+/// changes, and the workspace is then placed by the new policy.
+void ParamsBase::apply_mem_policy()
+{
+    if (mem_policy_param_ == nullptr || ! mem_policy_param_->used())
+        return;
+
+    MemPolicy policy = (*mem_policy_param_)();
+    if (policy != mem_placement_.policy) {
+        mem_placement_ = testsweeper::mem_placement( policy );
+        set_mem_policy( mem_placement_ );
+        workspace_.placement( mem_placement_ );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Applies framework parameters for the current point, before running it:
+/// number of threads, then memory policy, which is set in each thread.
+void ParamsBase::apply()
+{
+    apply_threads();
+    if (! bound_)
+        bind( bind_worker_, bind_nworkers_ );
+    apply_mem_policy();
+}
+
+// -----------------------------------------------------------------------------
+/// For `--noise`, finds the application's noise outputs, if any,
+/// by name: freq, vol cs, invol cs, minflt, majflt, and disturbed.
+/// Their columns are shown only with `--noise`.
+void ParamsBase::parse_noise()
+{
+    auto output = [this]( const char* name, auto* param ) {
+        ParamBase* found = find_output( name );
+        if (found != nullptr)
+            found->used( noise_ );
+        *param = noise_
+               ? dynamic_cast< std::remove_reference_t< decltype(*param) > >( found )
+               : nullptr;
+    };
+    output( "freq",      &noise_freq_      );
+    output( "vol cs",    &noise_vol_cs_    );
+    output( "invol cs",  &noise_invol_cs_  );
+    output( "minflt",    &noise_minflt_    );
+    output( "majflt",    &noise_majflt_    );
+    output( "disturbed", &noise_disturbed_ );
+}
+
+// -----------------------------------------------------------------------------
+/// For `--energy`, finds the application's energy and Gflop/J outputs,
+/// if any. Their columns are shown only with `--energy`.
+void ParamsBase::parse_energy()
+{
+    auto output = [this]( const char* name ) {
+        ParamBase* found = find_output( name );
+        if (found != nullptr)
+            found->used( energy_ );
+        return energy_ ? dynamic_cast< TParamBase< double >* >( found )
+                       : nullptr;
+    };
+    energy_param_    = output( "energy" );
+    gflop_per_joule_ = output( "Gflop/J" );
+}
+
+// -----------------------------------------------------------------------------
+/// For `--alloc`, finds the application's peak RSS, allocs, and alloc bytes
+/// outputs, if any, and enables counting heap allocations.
+/// Their columns are shown only with `--alloc`.
+void ParamsBase::parse_alloc()
+{
+    auto output = [this]( const char* name, auto* param ) {
+        ParamBase* found = find_output( name );
+        if (found != nullptr)
+            found->used( alloc_ );
+        *param = alloc_
+               ? dynamic_cast< std::remove_reference_t< decltype(*param) > >( found )
+               : nullptr;
+    };
+    output( "peak RSS",    &alloc_peak_rss_ );
+    output( "allocs",      &alloc_count_    );
+    output( "alloc bytes", &alloc_bytes_    );
+    alloc_tracking( alloc_ );
+}
+
+// -----------------------------------------------------------------------------
+/// Prepares for the next run of the routine: rewinds the workspace.
+void ParamsBase::begin_run()
+{
+    workspace_.rewind();
+}
+
+// -----------------------------------------------------------------------------
+/// Finishes outputs of the current run that the framework computes from
+/// other outputs, before reporting it: speedup and efficiency for
+/// `--threads`, and the count of disturbed runs for `--noise`.
+///
+/// @param[in] time
+///     Time of current run, e.g., params.time().
+///
+void ParamsBase::end_run( double time )
+{
+    scaling( time );
+    if (noise_disturbed_ != nullptr && (*noise_disturbed_)() != 0)
+        disturbed_ += 1;
+}
+
+// -----------------------------------------------------------------------------
+/// Sets speedup and efficiency outputs for the current run, for `--threads`
+/// with multiple values. The baseline is the first run with the smallest
+/// number of threads at the same values of the other parameters, so
+/// threads should be listed in increasing order; runs before their
+/// baseline have no speedup.
+///
+/// @param[in] time
+///     Time of current run, e.g., params.time().
+///
+void ParamsBase::scaling( double time )
+{
+    if (speedup_param_ == nullptr || ! (time > 0))
+        return;
+    if (! compiled_)
+        compile();
+
+    // key is index of the combination of other parameters
+    uint64_t key = 0;
+    for (size_t i = 0; i < lists_.size(); ++i) {
+        if (lists_[ i ] != threads_param_)
+            key = key * radix_[ i ] + lists_[ i ]->index_;
+    }
+
+    double nthreads;
+    bool is_int;
+    threads_param_->number( "", &nthreads, &is_int );
+    if (nthreads == threads_min_)
+        scaling_base_.insert( { key, time } );  // keeps first
+
+    auto iter = scaling_base_.find( key );
+    if (iter == scaling_base_.end())
+        return;
+
+    double speedup = iter->second / time;
+    (*speedup_param_)() = speedup;
+    if (efficiency_param_ != nullptr)
+        (*efficiency_param_)() = speedup * threads_min_ / nthreads;
+}
+
+// -----------------------------------------------------------------------------
+/// Finds parameter by its command line option name, without leading "--".
+/// In the name, underscore matches either underscore or dash.
+///
+/// @return parameter, or null if not found.
+///
+ParamBase* ParamsBase::find( std::string const& name ) const
+{
+    std::string option = "--" + name;
+    ParamBase* param = find_option( option.c_str(), option.size() );
+    if (param == nullptr && name.find( '_' ) != std::string::npos) {
+        // '_' in name matches '-' in option, since '-' is subtraction
+        std::replace( option.begin(), option.end(), '_', '-' );
+        param = find_option( option.c_str(), option.size() );
+    }
+    return param;
+}
+
+// -----------------------------------------------------------------------------
+/// @return parameter with command line option given by first len chars of
+/// option, e.g., "--dim", or null if not found.
+/// If several parameters have the same option, returns the first registered.
+ParamBase* ParamsBase::find_option( const char* option, size_t len ) const
+{
+    if (! indexed_) {
+        options_.clear();
+        options_.reserve( params_.size() );
+        for (auto param : params_)
+            options_.emplace( param->option_, param );
+        indexed_ = true;
+    }
+    auto iter = options_.find( std::string( option, len ) );
+    if (iter == options_.end())
+        return nullptr;
+    return iter->second;
+}
+
+// -----------------------------------------------------------------------------
+/// @return parameter with given name, as find(), or else output parameter
+/// whose name matches ignoring case, punctuation, and a trailing unit in
+/// parentheses, e.g., "gflops" matches "Gflop/s" and
+/// "ref_time" matches "ref time (ms)". Returns null if not found.
+ParamBase* ParamsBase::find_output( std::string const& name ) const
+{
+    ParamBase* param = find( name );
+    if (param != nullptr)
+        return param;
+
+    auto normalize = []( std::string const& str ) {
+        std::string result;
+        for (char c : str) {
+            if (c == '(')
+                break;
+            if (isalnum( c ))
+                result += tolower( c );
+        }
+        return result;
+    };
+    std::string key = normalize( name );
+    for (auto output : params_) {
+        if (output->type_ == ParamType::Output
+            && ! key.empty() && normalize( output->name_ ) == key)
+            return output;
+    }
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+/// Sets derived parameters by evaluating their expressions
+/// at the current point, in the order given on the command line.
+///
+/// @return false if a derived or tuned value is outside its parameter's
+///         range, so the point can't run; the first such error is saved
+///         for invalid_message().
+bool ParamsBase::derive()
+{
+    try {
+        if (! tuned_.empty()) {
+            std::string type;
+            double size;
+            tune_key( &type, &size );
+            for (auto& item : tuned_) {
+                double value;
+                if (! tune_db_.lookup( routine_, type,
+                                       item.param->option_.substr( 2 ),
+                                       size, &value ))
+                    value = item.default_value;
+                item.param->number( value );
+            }
+        }
+        for (auto& item : derived_) {
+            item.param->number( item.expr.eval() );
+        }
+    }
+    catch (const std::runtime_error& ex) {
+        if (invalid_message_.empty())
+            invalid_message_ = ex.what();
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+/// Evaluates derived parameters and `--where` constraints at the current
+/// point. A point that is skipped is counted in invalid() if a derived
+/// value is out of range, else in rejected() if it fails a constraint.
+///
+/// @return true if the point should run.
+bool ParamsBase::admit()
+{
+    if (! derive()) {
+        invalid_ += 1;
+        return false;
+    }
+    if (! accept()) {
+        rejected_ += 1;
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @return true if the current point satisfies all `--where` constraints.
+bool ParamsBase::accept()
+{
+    for (auto const& expr : where_) {
+        if (expr.eval() == 0)
+            return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+/// Advances to the next point that satisfies all `--where` constraints
+/// and whose derived values are in range. Points that don't are never run;
+/// they are counted in rejected() or invalid().
+///
+/// @return true if there is another point; false if sweep is done.
+///
+bool ParamsBase::next()
+{
+    while (advance()) {
+        if (admit())
+            return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+/// Advances to the next point in the Cartesian product of parameter values.
+///
+/// @return true if there is another point; false if sweep is done.
+///
+bool ParamsBase::advance()
+{
+    if (! compiled_)
+        compile();
+
+    // "Cartesian product" iteration as mixed-radix counter,
+    // over only parameters with multiple values.
+    // uses reverse order so in output, parameters on right cycle fastest
+    for (size_t i = lists_.size(); i-- > 0; ) {
+        ParamBase* param = lists_[ i ];
+        if (++param->index_ < radix_[ i ]) {
+            return true;
+        }
+        param->index_ = 0;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+/// Resolves parameters once after parsing, so iterating, printing, and
+/// resetting outputs for each point touch only the parameters that matter:
+/// parameters with multiple values for next(),
+/// visible columns for print(), and outputs for reset_output().
+/// Called by parse(); parameters must not be added or re-parsed after.
+void ParamsBase::compile()
+{
+    lists_.clear();
+    radix_.clear();
+    columns_.clear();
+    outputs_.clear();
+    for (auto param : params_) {
+        if (param->size() > 1) {
+            lists_.push_back( param );
+            radix_.push_back( param->size() );
+        }
+        if (param->width_ > 0)
+            columns_.push_back( param );
+        if (param->type_ == ParamType::Output)
+            outputs_.push_back( param );
+    }
+    compiled_ = true;
+}
+
+// -----------------------------------------------------------------------------
+/// @return number of points in Cartesian product of parameter values,
+/// including points that may be rejected by `--where` constraints.
+int64_t ParamsBase::num_points()
+{
+    if (! compiled_)
+        compile();
+    int64_t cnt = 1;
+    for (size_t r : radix_)
+        cnt *= r;
+    return cnt;
+}
+
+// -----------------------------------------------------------------------------
+/// @return index of current point, in [0, num_points()),
+/// as the mixed-radix number of parameter indices.
+int64_t ParamsBase::point()
+{
+    if (! compiled_)
+        compile();
+    int64_t index = 0;
+    for (size_t i = 0; i < lists_.size(); ++i)
+        index = index * radix_[ i ] + lists_[ i ]->index_;
+    return index;
+}
+
+// -----------------------------------------------------------------------------
+/// @return key for random test data at the current point, for random_fill.
+/// Like point(), but ignores `--threads` and `--mem-policy`, so runs that
+/// differ only in how they execute get the same data.
+uint64_t ParamsBase::random_key()
+{
+    if (! compiled_)
+        compile();
+    uint64_t key = 0;
+    for (size_t i = 0; i < lists_.size(); ++i) {
+        if (lists_[ i ] == threads_param_ || lists_[ i ] == mem_policy_param_)
+            continue;
+        key = key * radix_[ i ] + lists_[ i ]->index_;
+    }
+    return key;
+}
+
+// -----------------------------------------------------------------------------
+/// Sets the routine's check outputs from diff, e.g., from difference().
+/// Error is the norm-wise relative error, and okay (status) is
+/// error <= tol. Outputs named ulp and mismatch, if the routine marked
+/// them used, are set to the max ULP distance and index of first mismatch.
+///
+/// @param[in] diff
+///     Differences between result and reference.
+///
+/// @param[in] tol
+///     Tolerance for error, e.g., params.tol() * epsilon.
+///
+void ParamsBase::verify( Difference const& diff, double tol )
+{
+    auto set = [this]( const char* name, double value ) {
+        ParamBase* found = find_output( name );
+        if (found == nullptr || ! found->used())
+            return;
+        if (auto dparam = dynamic_cast< TParamBase< double >* >( found ))
+            (*dparam)() = value;
+        else if (auto iparam = dynamic_cast< TParamBase< int64_t >* >( found ))
+            (*iparam)() = int64_t( value );
+    };
+    set( "error",    diff.norm );
+    set( "status",   diff.norm <= tol );
+    set( "ulp",      double( diff.max_ulp ) );
+    set( "mismatch", double( diff.first ) );
+}
+
+// -----------------------------------------------------------------------------
+/// @return 64-bit hash of bytes of data, continuing from hash h.
+/// Processes 8 bytes at a time; not cryptographic.
+static uint64_t hash_bytes( const void* data, size_t bytes, uint64_t h )
+{
+    const unsigned char* ptr = (const unsigned char*) data;
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t word;
+        memcpy( &word, ptr + i, 8 );
+        h = (h ^ word) * 0x9E3779B97F4A7C15;
+        h ^= h >> 29;
+    }
+    for (; i < bytes; ++i) {
+        h = (h ^ ptr[ i ]) * 0x100000001B3;
+    }
+    h ^= bytes;
+    // final mix, from splitmix64
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EB;
+    return h ^ (h >> 31);
+}
+
+// -----------------------------------------------------------------------------
+/// Header of reference result files, for `--ref-cache`; 64 bytes, so data
+/// after it is aligned for any type.
+struct RefHeader {
+    char     magic[ 8 ];
+    uint64_t key;
+    uint64_t bytes;
+    char     unused[ 40 ];
+};
+
+static_assert( sizeof(RefHeader) == 64, "RefHeader size" );
+
+static const char ref_magic[ 8 ] = "TSREF01";
+
+// -----------------------------------------------------------------------------
+/// @return key of the reference result for the current point and given
+/// input, for ref_find and ref_store. The key is a hash of the routine,
+/// `--seed`, values of list parameters such as type and dim, and input.
+/// `--threads` and `--mem-policy` are ignored, as they don't change results.
+///
+/// @param[in] input
+///     Input to the reference implementation, e.g., a matrix.
+///
+/// @param[in] bytes
+///     Size of input in bytes.
+///
+uint64_t ParamsBase::ref_key( const void* input, size_t bytes )
+{
+    uint64_t h = hash_bytes( routine_.data(), routine_.size(), 0 );
+    h = hash_bytes( &seed_, sizeof(seed_), h );
+    std::vector< ParamValue > row;
+    for (auto param : params_) {
+        if (param->type_ == ParamType::List && param->used_
+            && param != threads_param_ && param != mem_policy_param_)
+        {
+            param->values( row );
+        }
+    }
+    for (auto const& value : row) {
+        h = hash_bytes( value.name.data(), value.name.size(), h );
+        h = hash_bytes( &value.value, sizeof(value.value), h );
+        h = hash_bytes( value.text.data(), value.text.size(), h );
+    }
+    return hash_bytes( input, bytes, h );
+}
+
+// -----------------------------------------------------------------------------
+/// @return path of the cache file for key, e.g., dir/sort-0123456789abcdef.ref
+std::string ParamsBase::ref_path( uint64_t key ) const
+{
+    char name[ 32 ];
+    snprintf( name, sizeof(name), "-%016llx.ref", (unsigned long long) key );
+    return ref_cache_dir_ + "/" + routine_ + name;
+}
+
+// -----------------------------------------------------------------------------
+/// Finds a reference result saved by ref_store, in this or an earlier run,
+/// with `--ref-cache`. The file is memory mapped, read-only, and stays
+/// mapped for the rest of the current point, so repeats reuse it.
+///
+/// @param[in] key
+///     Key from ref_key.
+///
+/// @param[in] bytes
+///     Expected size of result in bytes.
+///
+/// @return pointer to the result, or nullptr if not cached.
+///
+const void* ParamsBase::ref_find( uint64_t key, size_t bytes )
+{
+    if (! ref_cache())
+        return nullptr;
+
+    int64_t point = this->point();
+    if (point != ref_point_) {
+        ref_release();
+        ref_point_ = point;
+    }
+    size_t size = sizeof(RefHeader) + bytes;
+    for (auto const& map : ref_maps_) {
+        if (map.key == key && map.size == size)
+            return (char*) map.base + sizeof(RefHeader);
+    }
+
+#ifndef _WIN32
+    int fd = open( ref_path( key ).c_str(), O_RDONLY );
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    void* base = MAP_FAILED;
+    if (fstat( fd, &st ) == 0 && size_t( st.st_size ) == size)
+        base = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if (base == MAP_FAILED)
+        return nullptr;
+
+    auto header = (RefHeader const*) base;
+    if (memcmp( header->magic, ref_magic, sizeof(ref_magic) ) != 0
+        || header->key != key || header->bytes != bytes)
+    {
+        munmap( base, size );
+        return nullptr;
+    }
+    ref_maps_.push_back( { key, base, size } );
+    return (char*) base + sizeof(RefHeader);
+#else
+    return nullptr;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+/// Saves a reference result for later ref_find, with `--ref-cache`.
+/// The file is written under a temporary name, then renamed, so
+/// concurrent testers, e.g., with `--workers`, never see partial files.
+/// Throws error if the file can't be written.
+///
+/// @param[in] key
+///     Key from ref_key.
+///
+/// @param[in] data
+///     Reference result.
+///
+/// @param[in] bytes
+///     Size of result in bytes.
+///
+void ParamsBase::ref_store( uint64_t key, const void* data, size_t bytes )
+{
+    if (! ref_cache())
+        return;
+
+#ifndef _WIN32
+    mkdir( ref_cache_dir_.c_str(), 0777 );  // may exist
+
+    RefHeader header;
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, ref_magic, sizeof(ref_magic) );
+    header.key   = key;
+    header.bytes = bytes;
+
+    std::string path = ref_path( key );
+    std::string tmp  = path + ".tmp" + std::to_string( getpid() );
+    FILE* file = fopen( tmp.c_str(), "wb" );
+    if (file == nullptr) {
+        throw_error( "can't write reference cache %s: %s",
+                     tmp.c_str(), strerror( errno ) );
+    }
+    bool ok = fwrite( &header, sizeof(header), 1, file ) == 1
+           && fwrite( data, 1, bytes, file ) == bytes;
+    ok = (fclose( file ) == 0) && ok;
+    if (! ok || rename( tmp.c_str(), path.c_str() ) != 0) {
+        int err = errno;
+        ::remove( tmp.c_str() );
+        throw_error( "can't write reference cache %s: %s",
+                     path.c_str(), strerror( err ) );
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+/// Unmaps reference results mapped by ref_find.
+void ParamsBase::ref_release()
+{
+#ifndef _WIN32
+    for (auto const& map : ref_maps_)
+        munmap( map.base, map.size );
+#endif
+    ref_maps_.clear();
+    ref_point_ = -1;
+}
+
+// -----------------------------------------------------------------------------
+/// Sets current point to given index, in [0, num_points()),
+/// and evaluates derived parameters. Doesn't check `--where` constraints,
+/// so index should be a point that next() returned.
+void ParamsBase::seek( int64_t index )
+{
+    if (! compiled_)
+        compile();
+    for (size_t i = lists_.size(); i-- > 0; ) {
+        lists_[ i ]->index_ = index % radix_[ i ];
+        index /= radix_[ i ];
+    }
+    (void) derive();
+}
+
+// -----------------------------------------------------------------------------
+/// Formats value as its text, if any, else as a number.
+static std::string format_value( ParamValue const& value )
+{
+    if (! value.text.empty())
+        return value.text;
+    char buf[ 80 ];
+    if (std::isnan( value.value ) || std::isinf( value.value ))
+        snprintf( buf, sizeof(buf), "NA" );
+    else if (value.value == std::floor( value.value )
+             && std::abs( value.value ) < 1e15)
+        snprintf( buf, sizeof(buf), "%lld", (long long) value.value );
+    else
+        snprintf( buf, sizeof(buf), "%.4g", value.value );
+    return buf;
+}
+
+// -----------------------------------------------------------------------------
+/// @return number of values of tuned parameter.
+size_t ParamsBase::tune_size() const
+{
+    return tune_param_->size();
+}
+
+// -----------------------------------------------------------------------------
+/// Starts tuning at the first combination of parameters.
+void ParamsBase::tune_begin()
+{
+    if (! compiled_)
+        compile();
+    tune_results_.clear();
+    tune_rejected_.assign( tune_size(), false );
+    for (size_t i = 0; i < lists_.size(); ++i) {
+        lists_[ i ]->index_ = 0;
+        if (lists_[ i ] == tune_param_)
+            tune_pos_ = i;
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Sets tuned parameter to its index-th value, and evaluates derived
+/// parameters. A rejected point is counted once, though the search may
+/// seek it once per repeat.
+/// @return true if the point satisfies `--where` constraints and its
+///         derived values are in range.
+bool ParamsBase::tune_seek( size_t index )
+{
+    tune_param_->index_ = index;
+    if (tune_rejected_[ index ])
+        return false;
+    if (admit())
+        return true;
+    tune_rejected_[ index ] = true;
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+/// Advances to next combination of parameters other than the tuned one,
+/// like next() without constraints.
+/// @return false after the last combination.
+bool ParamsBase::tune_next()
+{
+    tune_rejected_.assign( tune_rejected_.size(), false );
+    for (size_t i = lists_.size(); i-- > 0; ) {
+        if (i == tune_pos_)
+            continue;
+        ParamBase* param = lists_[ i ];
+        if (++param->index_ < radix_[ i ]) {
+            return true;
+        }
+        param->index_ = 0;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+/// @return objective to maximize at the current point: the output from
+/// `--maximize`, or the negated output from `--minimize`.
+/// Missing data is -infinity.
+double ParamsBase::tune_objective() const
+{
+    double value;
+    bool is_int;
+    if (! tune_output_->number( "", &value, &is_int ) || std::isnan( value ))
+        return -std::numeric_limits<double>::infinity();
+    return tune_maximize_ ? value : -value;
+}
+
+// -----------------------------------------------------------------------------
+/// Records best value of tuned parameter for the current combination of
+/// other parameters, for tune_print().
+///
+/// @param[in] best
+///     Index of best value of tuned parameter.
+///
+/// @param[in] objective
+///     Mean objective at best value, as returned by tune_objective().
+///     If -infinity, every value was rejected or failed, so there is
+///     no feasible point, and best is ignored.
+///
+/// @param[in] evals
+///     Number of runs of the routine to find best value.
+///
+void ParamsBase::tune_record( size_t best, double objective, int evals )
+{
+    bool feasible = objective > -std::numeric_limits< double >::infinity();
+    if (feasible) {
+        tune_param_->index_ = best;
+        (void) derive();
+    }
+
+    // only parameters with multiple values, to keep the table compact
+    TuneResult result;
+    for (auto param : lists_) {
+        if (param->used_ && param->width_ > 0 && param != tune_param_)
+            param->values( result.inputs );
+    }
+    if (feasible) {
+        std::vector< ParamValue > best_value;
+        tune_param_->values( best_value );
+        result.best = best_value.at( 0 );
+    }
+    else {
+        result.best = { tune_param_->option_.substr( 2 ),
+                        std::numeric_limits< double >::quiet_NaN(), "none" };
+    }
+    result.objective = tune_maximize_ ? objective : -objective;
+    result.evals = evals;
+    tune_key( &result.type, &result.size );
+    tune_results_.push_back( result );
+}
+
+// -----------------------------------------------------------------------------
+/// Stores best values from tuning in the tuning database file,
+/// replacing earlier values for the same keys.
+/// Does nothing unless `--tune-db` gave a file.
+void ParamsBase::tune_save()
+{
+    if (tune_db_file_.empty())
+        return;
+    if (! tune_db_loaded_) {
+        tune_db_.load( tune_db_file_ );
+        tune_db_loaded_ = true;
+    }
+    std::string param = tune_param_->option_.substr( 2 );
+    for (auto const& result : tune_results_) {
+        if (! std::isinf( result.objective ) && ! std::isnan( result.objective ))
+            tune_db_.store( routine_, result.type, param,
+                            result.size, result.best.value );
+    }
+    tune_db_.save( tune_db_file_ );
+}
+
+// -----------------------------------------------------------------------------
+/// Gets tuning database key for the current point: datatype is the value of
+/// the `type` parameter, or "-" if there isn't one; size is the largest
+/// used component of the `dim` parameter, or 0 if there isn't one.
+void ParamsBase::tune_key( std::string* type, double* size ) const
+{
+    *type = "-";
+    *size = 0;
+    std::vector< ParamValue > values;
+    ParamBase* type_param = find( "type" );
+    if (type_param != nullptr && type_param->used_) {
+        type_param->values( values );
+        if (! values.empty())
+            *type = format_value( values[ 0 ] );
+    }
+    values.clear();
+    ParamBase* dim = find( "dim" );
+    if (dim != nullptr && dim->used_) {
+        dim->values( values );
+        for (auto const& value : values)
+            *size = std::max( *size, value.value );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Prints compact table of best values of tuned parameter, one row per
+/// combination of other parameters.
+void ParamsBase::tune_print() const
+{
+    const char* strategies[] = { "grid", "golden", "halving" };
+    std::string tune = tune_param_->option_.substr( 2 );
+    printf( "\n%sTuning %s to %s %s, %s search:%s\n",
+            ansi_bold, tune.c_str(),
+            tune_maximize_ ? "maximize" : "minimize",
+            tune_output_->name_.c_str(),
+            strategies[ int( tune_strategy_ ) ], ansi_normal );
+
+    // table of strings, first row is header
+    std::vector< std::vector< std::string > > table;
+    table.emplace_back();
+    if (! tune_results_.empty()) {
+        for (auto const& value : tune_results_[ 0 ].inputs)
+            table[ 0 ].push_back( value.name );
+    }
+    table[ 0 ].push_back( "best " + tune );
+    table[ 0 ].push_back( tune_output_->name_ );
+    table[ 0 ].push_back( "evals" );
+    for (auto const& result : tune_results_) {
+        table.emplace_back();
+        auto& row = table.back();
+        for (auto const& value : result.inputs)
+            row.push_back( format_value( value ) );
+        row.push_back( format_value( result.best ) );
+        row.push_back( format_value( { "", result.objective, "" } ) );
+        row.push_back( std::to_string( result.evals ) );
+    }
+
+    std::vector< size_t > widths( table[ 0 ].size(), 0 );
+    for (auto const& row : table) {
+        for (size_t j = 0; j < row.size() && j < widths.size(); ++j)
+            widths[ j ] = std::max( widths[ j ], row[ j ].size() );
+    }
+    for (auto const& row : table) {
+        for (size_t j = 0; j < row.size() && j < widths.size(); ++j)
+            printf( "%*s  ", int( widths[ j ] ), row[ j ].c_str() );
+        printf( "\n" );
+    }
+
+    int64_t infeasible = 0;
+    for (auto const& result : tune_results_)
+        infeasible += std::isinf( result.objective );
+    if (infeasible > 0) {
+        printf( "No feasible point in %lld of %lld combinations:"
+                " every value of %s was rejected or failed.\n",
+                (long long) infeasible, (long long) tune_results_.size(),
+                tune.c_str() );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Searches for index in [0, n) that maximizes the mean of eval( index )
+/// over repeat runs, where eval runs one test and returns its objective.
+///
+/// @param[in] strategy
+///     - Grid:    evaluates every index.
+///     - Golden:  golden-section search, assuming the objective is unimodal;
+///                evaluates about 1.44 log2( n ) indices.
+///     - Halving: evaluates every index, then repeatedly keeps the better
+///                half, doubling their runs, until one remains.
+///
+/// @param[in] n
+///     Number of indices.
+///
+/// @param[in] repeat
+///     Runs per index; for Halving, runs in first round.
+///
+/// @param[in] eval
+///     Runs test at index, returning objective; -infinity if it failed.
+///
+/// @param[out] objective
+///     Mean objective at best index.
+///
+/// @param[out] evals
+///     Total number of calls to eval.
+///
+/// @return best index. Ties are broken by the lowest index.
+///
+size_t tune_search(
+    TuneStrategy strategy, size_t n, int repeat,
+    std::function< double (size_t) > const& eval,
+    double* objective, int* evals )
+{
+    assert( n > 0 );
+    repeat = std::max( repeat, 1 );
+    std::vector< double > sum( n, 0 );
+    std::vector< int > runs( n, 0 );
+    *evals = 0;
+
+    // Runs index until it has cnt runs; returns mean objective.
+    auto mean = [&]( size_t index, int cnt ) {
+        for (; runs[ index ] < cnt; ++runs[ index ]) {
+            sum[ index ] += eval( index );
+            *evals += 1;
+        }
+        return sum[ index ] / runs[ index ];
+    };
+
+    size_t best = 0;
+    if (strategy == TuneStrategy::Halving) {
+        std::vector< size_t > alive( n );
+        std::iota( alive.begin(), alive.end(), 0 );
+        int cnt = repeat;
+        while (alive.size() > 1) {
+            for (size_t index : alive)
+                mean( index, cnt );
+            // keep better half; stable sort breaks ties by lower index
+            std::stable_sort(
+                alive.begin(), alive.end(),
+                [&]( size_t a, size_t b ) {
+                    return sum[ a ] / runs[ a ] > sum[ b ] / runs[ b ];
+                } );
+            alive.resize( (alive.size() + 1) / 2 );
+            cnt *= 2;
+        }
+        best = alive[ 0 ];
+        *objective = mean( best, runs[ best ] > 0 ? runs[ best ] : repeat );
+        return best;
+    }
+
+    size_t lo = 0, hi = n - 1;
+    if (strategy == TuneStrategy::Golden) {
+        // Narrow [lo, hi] until at most 3 indices remain.
+        const double r = 0.6180339887498949;  // 1/phi
+        while (hi - lo > 2) {
+            size_t b = lo + size_t( std::round( (hi - lo) * r ) );
+            size_t a = hi - (b - lo);
+            if (a >= b)
+                a = b - 1;
+            if (mean( a, repeat ) < mean( b, repeat ))
+                lo = a + 1;
+            else
+                hi = b - 1;
+        }
+    }
+    best = lo;
+    *objective = mean( lo, repeat );
+    for (size_t index = lo + 1; index <= hi; ++index) {
+        double value = mean( index, repeat );
+        if (value > *objective) {
+            *objective = value;
+            best = index;
+        }
+    }
+    return best;
+}
+
+// -----------------------------------------------------------------------------
+/// @return power-of-2 bucket of size, floor( log2( size ) ), or -1 if size <= 0.
+static int size_bucket( double size )
+{
+    return size > 0 ? int( std::floor( std::log2( size ) ) ) : -1;
+}
+
+// -----------------------------------------------------------------------------
+/// Reads records from file, replacing current records.
+/// A missing file is an empty database.
+void TuneDB::load( std::string const& filename )
+{
+    records_.clear();
+    FILE* file = fopen( filename.c_str(), "r" );
+    if (file == nullptr)
+        return;
+
+    char line[ 1024 ];
+    char machine[ 256 ], routine[ 256 ], type[ 256 ], param[ 256 ];
+    while (fgets( line, sizeof(line), file ) != nullptr) {
+        Record record;
+        if (line[ 0 ] != '#'
+            && sscanf( line, "%255s %255s %255s %255s %lf %lf",
+                       machine, routine, type, param,
+                       &record.size, &record.value ) == 6)
+        {
+            record.machine = machine;
+            record.routine = routine;
+            record.type    = type;
+            record.param   = param;
+            records_.push_back( record );
+        }
+    }
+    fclose( file );
+}
+
+// -----------------------------------------------------------------------------
+/// Writes all records to file.
+void TuneDB::save( std::string const& filename ) const
+{
+    FILE* file = fopen( filename.c_str(), "w" );
+    if (file == nullptr)
+        throw_error( "cannot write tuning database '%s'", filename.c_str() );
+
+    fprintf( file, "# machine routine type param size value\n" );
+    for (auto const& record : records_) {
+        fprintf( file, "%s %s %s %s %.17g %.17g\n",
+                 record.machine.c_str(), record.routine.c_str(),
+                 record.type.c_str(), record.param.c_str(),
+                 record.size, record.value );
+    }
+    fclose( file );
+}
+
+// -----------------------------------------------------------------------------
+/// Stores value for this machine, replacing any value in the same
+/// size bucket.
+void TuneDB::store(
+    std::string const& routine, std::string const& type,
+    std::string const& param, double size, double value )
+{
+    Record record = { machine(), routine, type, param, size, value };
+    for (auto& old : records_) {
+        if (old.machine == record.machine && old.routine == routine
+            && old.type == type && old.param == param
+            && size_bucket( old.size ) == size_bucket( size ))
+        {
+            old = record;
+            return;
+        }
+    }
+    records_.push_back( record );
+}
+
+// -----------------------------------------------------------------------------
+/// Looks up value for this machine. Between stored sizes, interpolates
+/// linearly in log2( size ); outside them, uses the nearest.
+///
+/// @return true if found; false if no values stored for the key.
+bool TuneDB::lookup(
+    std::string const& routine, std::string const& type,
+    std::string const& param, double size, double* value ) const
+{
+    Record const* lower = nullptr;
+    Record const* upper = nullptr;
+    for (auto const& record : records_) {
+        if (record.machine != machine() || record.routine != routine
+            || record.type != type || record.param != param)
+            continue;
+        if (record.size <= size
+            && (lower == nullptr || record.size > lower->size))
+            lower = &record;
+        if (record.size >= size
+            && (upper == nullptr || record.size < upper->size))
+            upper = &record;
+    }
+    if (lower == nullptr && upper == nullptr)
+        return false;
+    if (lower == nullptr || upper == nullptr || lower->size == upper->size
+        || lower->size <= 0)
+    {
+        *value = (lower != nullptr ? lower : upper)->value;
+        return true;
+    }
+    double t = (std::log2( size ) - std::log2( lower->size ))
+             / (std::log2( upper->size ) - std::log2( lower->size ));
+    *value = lower->value + t * (upper->value - lower->value);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+/// @return fingerprint of this machine, as host/arch/cpu-model/ncores,
+/// with spaces replaced by underscores.
+std::string const& TuneDB::machine()
+{
+    static std::string fingerprint = [] {
+        std::string result = "unknown";
+    #ifndef _WIN32
+        struct utsname name;
+        if (uname( &name ) == 0)
+            result = std::string( name.nodename ) + "/" + name.machine;
+
+        // CPU model, on Linux
+        std::string model = "unknown";
+        FILE* file = fopen( "/proc/cpuinfo", "r" );
+        if (file != nullptr) {
+            char line[ 1024 ];
+            while (fgets( line, sizeof(line), file ) != nullptr) {
+                if (strncmp( line, "model name", 10 ) == 0) {
+                    const char* colon = strchr( line, ':' );
+                    if (colon != nullptr) {
+                        model = colon + 1;
+                        size_t begin = model.find_first_not_of( " \t" );
+                        size_t end   = model.find_last_not_of( " \t\n" );
+                        model = (begin == std::string::npos)
+                              ? "unknown"
+                              : model.substr( begin, end - begin + 1 );
+                    }
+                    break;
+                }
+            }
+            fclose( file );
+        }
+        result += "/" + model + "/"
+               +  std::to_string( sysconf( _SC_NPROCESSORS_ONLN ) );
+    #endif
+        for (auto& c : result) {
+            if (isspace( c ))
+                c = '_';
+        }
+        return result;
+    }();
+    return fingerprint;
+}
+
+// -----------------------------------------------------------------------------
+void ParamsBase::header()
+{
+    print_bind();
+    for (int line = 0; line < 2; ++line) {
+        for (auto param  = params_.begin();
+                  param != params_.end();
+                ++param)
+        {
+            (*param)->header( line );
+        }
+        printf( "\n" );
+    }
+}
+
+// -----------------------------------------------------------------------------
+void ParamsBase::print()
+{
+    if (! compiled_)
+        compile();
+
+    // Check used here to avoid virtual call for unused columns.
+    for (auto param : columns_) {
+        if (param->used_)
+            param->print();
+    }
+    printf( "\n" );
+}
+
+// -----------------------------------------------------------------------------
+void ParamsBase::reset_output()
+{
+    if (! compiled_)
+        compile();
+
+    for (auto param : outputs_) {
+        param->reset_output();
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Appends values of visible, used columns at the current point to row,
+/// in output order, e.g., for TableSink.
+///
+/// @param[in,out] row
+///     Values of columns at the current point.
+void ParamsBase::values( std::vector< ParamValue >& row )
+{
+    if (! compiled_)
+        compile();
+
+    for (auto param : columns_) {
+        if (param->used_)
+            param->values( row );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Appends values of output parameters at the current point to buf,
+/// to send from an isolated child process; see isolate_sweep.
+void ParamsBase::pack_outputs( std::string& buf )
+{
+    if (! compiled_)
+        compile();
+
+    for (auto param : outputs_) {
+        param->pack( buf );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Sets values of output parameters at the current point from buf,
+/// as packed by pack_outputs().
+void ParamsBase::unpack_outputs( std::string const& buf )
+{
+    if (! compiled_)
+        compile();
+
+    const char* pos = buf.data();
+    for (auto param : outputs_) {
+        pos = param->unpack( pos );
+    }
+    assert( pos == buf.data() + buf.size() );
+}
+
+// -----------------------------------------------------------------------------
+/// Restores all parameters to their defaults, as before parse().
+/// Used between blocks of a sweep specification file (`--spec`),
+/// so one process can run several sweeps back-to-back.
+void ParamsBase::reset()
+{
+    for (auto param  = params_.begin();
+              param != params_.end();
+            ++param)
+    {
+        (*param)->reset();
+    }
+    where_.clear();
+    derived_.clear();
+    rejected_ = 0;
+    invalid_ = 0;
+    invalid_message_.clear();
+    empty_ = false;
+    compiled_ = false;
+    tune_param_  = nullptr;
+    tune_output_ = nullptr;
+    tune_maximize_ = true;
+    tune_strategy_ = TuneStrategy::Grid;
+    tune_results_.clear();
+    tuned_.clear();
+    tune_db_file_.clear();
+    tune_db_ = TuneDB();
+    tune_db_loaded_ = false;
+    isolate_ = 0;
+    workers_ = 0;
+    unbind();
+    bind_.clear();
+    scaling_base_.clear();
+    noise_ = false;
+    monitor_running_ = false;
+    disturbed_ = 0;
+    energy_ = false;
+    energy_root_ = "/sys/class/powercap";
+    alloc_ = false;
+    if (mem_placement_.policy != MemPolicy::Default) {
+        // later blocks without --mem-policy get the default policy
+        mem_placement_ = MemPlacement();
+        set_mem_policy( mem_placement_ );
+        workspace_.placement( mem_placement_ );
+    }
+    workspace_.alignment( 64 );
+    workspace_.huge_pages( false );
+    workspace_.prefault( false );
+    workspace_.poison( false );
+    seed_ = 0;
+    ref_release();
+    ref_cache_dir_.clear();
+}
+
+// -----------------------------------------------------------------------------
+void ParamsBase::help( const char *routine )
+{
+    // todo: pass in argv[0] instead of assuming test.
+    printf( "%sUsage:%s test [-h|--help]\n"
+            "       test [-h|--help] routine\n"
+            "       test [parameters] routine\n\n"
+            "%sParameters for %s:%s\n",
+            ansi_bold, ansi_normal,
+            ansi_bold, routine, ansi_normal );
+    for (auto param  = params_.begin();
+              param != params_.end();
+            ++param)
+    {
+        if ((*param)->used_ && (*param)->type_ == ParamType::Value)
+            (*param)->help();
+    }
+    printf( "\n%sParameters that take comma-separated list of values and may be repeated:%s\n",
+            ansi_bold, ansi_normal );
+    for (auto param  = params_.begin();
+              param != params_.end();
+            ++param)
+    {
+        if ((*param)->used_ && (*param)->type_ == ParamType::List)
+            (*param)->help();
+    }
+    printf( "\n%sExpressions over parameters:%s\n"
+            "    %-16s %s\n"
+            "    %-16s %s\n",
+            ansi_bold, ansi_normal,
+            "--where",
+            "skip points that don't satisfy expression,"
+            " e.g., 'dim.m >= dim.n && nb <= dim.n'; may be repeated",
+            "--param =expr",
+            "derive numeric parameter from other parameters at each point,"
+            " e.g., --nb '=clamp( dim.m/16, 32, 512 )'" );
+    printf( "\n%sRunning:%s\n"
+            "    %-16s %s\n",
+            ansi_bold, ansi_normal,
+            "--isolate [N]",
+            "run each block of N points (default 1) in a child process,"
+            " so crashes fail only that point" );
+    printf( "    %-16s %s\n",
+            "--workers N",
+            "run points in N worker processes, handing each the next point"
+            " as it finishes; results are printed in the usual order" );
+    printf( "    %-16s %s\n",
+            "--noise",
+            "record CPU frequency, context switches, and page faults of each"
+            " run, and flag runs that may be disturbed by system noise" );
+    printf( "    %-16s %s\n"
+            "    %-16s %s\n",
+            "--energy",
+            "measure energy of each run from RAPL counters, for energy"
+            " and Gflop/J outputs",
+            "--energy-root",
+            "directory of RAPL counters; default /sys/class/powercap" );
+    printf( "    %-16s %s\n",
+            "--alloc",
+            "record peak RSS growth, and count and bytes of heap allocations,"
+            " of each run" );
+    printf( "    %-16s %s\n"
+            "    %-16s %s\n"
+            "    %-16s %s\n"
+            "    %-16s %s\n",
+            "--align",
+            "alignment in bytes of workspace buffers, a power of 2; default 64",
+            "--huge-pages",
+            "use transparent huge pages for workspace",
+            "--prefault",
+            "touch workspace pages when allocated",
+            "--poison",
+            "fill workspace with 0xff (NaN) before each run, to catch"
+            " use of stale data" );
+    printf( "    %-16s %s\n",
+            "--seed",
+            "seed for random test data; default 0" );
+    printf( "    %-16s %s\n",
+            "--ref-cache",
+            "directory to save reference results in, keyed by routine,"
+            " parameters, seed, and input, and reuse them in later runs" );
+    printf( "    %-16s %s\n",
+            "--bind",
+            "bind threads to CPUs: cores (one thread per core), sockets"
+            " (one socket per process), or CPU list, e.g., 0-3,8" );
+    printf( "\n%sTuning:%s\n"
+            "    %-16s %s\n"
+            "    %-16s %s\n"
+            "    %-16s %s\n"
+            "    %-16s %s\n"
+            "    %-16s %s\n"
+            "    %-16s %s\n",
+            ansi_bold, ansi_normal,
+            "--tune",
+            "parameter to tune, e.g., --tune nb; searches its values"
+            " at each combination of other parameters",
+            "--maximize",
+            "output to maximize; default gflops",
+            "--minimize",
+            "output to minimize, e.g., time",
+            "--tune-strategy",
+            "grid, golden (for unimodal objective), or halving; default grid",
+            "--tune-db",
+            "file of tuned values; --tune saves to it only if given",
+            "--param tuned",
+            "take numeric parameter from tuning database, interpolating"
+            " between sizes, e.g., --nb tuned" );
+}
+
+// =============================================================================
+// Summary class
+// Aggregates results by datatype and size class.
+
+// -----------------------------------------------------------------------------
+/// @return label for power-of-2 size class containing size,
+/// e.g., size 300 is in class "256-511".
+// static
+std::string Summary::size_class( int64_t size )
+{
+    if (size <= 0)
+        return "0";
+    int64_t lower = 1;
+    while (lower <= size / 2)
+        lower *= 2;
+    char buf[ 80 ];
+    snprintf( buf, sizeof(buf), "%lld-%lld",
+              (long long) lower, (long long) (2*lower - 1) );
+    return buf;
+}
+
+// -----------------------------------------------------------------------------
+/// @return group with given key, adding a new group if it doesn't exist.
+/// Groups are kept in order of first appearance, which matches sweep order.
+// static
+Summary::Group& Summary::find(
+    std::vector< Group >& groups, std::string const& key )
+{
+    for (auto& group : groups) {
+        if (group.key == key)
+            return group;
+    }
+    groups.push_back( Group() );
+    groups.back().key = key;
+    return groups.back();
+}
+
+// -----------------------------------------------------------------------------
+/// Adds result of one test to the summary.
+///
+/// @param[in] type
+///     Datatype of test, e.g., "d".
+///
+/// @param[in] size
+///     Problem size used to determine size class, e.g., dim.m().
+///
+/// @param[in] gflops
+///     Gflop/s rate of test; NaN (no_data_flag) if not available.
+///
+/// @param[in] ref_gflops
+///     Gflop/s rate of reference; NaN (no_data_flag) if not available.
+///
+/// @param[in] okay
+///     Status of test. Zero counts as failure;
+///     no_check and skipped do not.
+///
+void Summary::add( std::string const& type, int64_t size,
+                   double gflops, double ref_gflops, int64_t okay )
+{
+    std::string sclass = size_class( size );
+    std::string at = type + " " + std::to_string( size );
+    for (Group* group : { &find( by_type_, type ), &find( by_size_, sclass ) }) {
+        if (! std::isnan( gflops )) {
+            if (group->best_at.empty() || gflops > group->best) {
+                group->best    = gflops;
+                group->best_at = at;
+            }
+            if (group->worst_at.empty() || gflops < group->worst) {
+                group->worst    = gflops;
+                group->worst_at = at;
+            }
+            if (ref_gflops > 0 && gflops > 0
+                && std::isfinite( ref_gflops ) && std::isfinite( gflops )) {
+                group->log_speedup   += log( gflops / ref_gflops );
+                group->speedup_count += 1;
+            }
+        }
+        group->count  += 1;
+        group->failed += (okay == 0);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// static
+void Summary::print( const char* label, std::vector< Group > const& groups )
+{
+    printf( "\n%sSummary by %s:%s\n", ansi_bold, label, ansi_normal );
+    printf( "%-12s  %6s  %6s  %12s  %-16s  %12s  %-16s  %7s\n",
+            label, "tests", "failed",
+            "best Gflop/s", "at", "worst Gflop/s", "at", "speedup" );
+    for (auto const& group : groups) {
+        printf( "%-12s  %6lld  %6lld  ",
+                group.key.c_str(),
+                (long long) group.count, (long long) group.failed );
+        if (group.best_at.empty()) {
+            printf( "%12s  %-16s  %12s  %-16s  ", "NA", "", "NA", "" );
+        }
+        else {
+            printf( "%12.3f  %-16s  %12.3f  %-16s  ",
+                    group.best,  group.best_at.c_str(),
+                    group.worst, group.worst_at.c_str() );
+        }
+        if (group.speedup_count > 0) {
+            // geometric mean
+            printf( "%7.3f\n", exp( group.log_speedup / group.speedup_count ) );
+        }
+        else {
+            printf( "%7s\n", "NA" );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// Prints summary tables by datatype and by size class.
+void Summary::print() const
+{
+    print( "type", by_type_ );
+    print( "size", by_size_ );
+    if (repeat_ > 1) {
+        printf( "\nEach point was repeated %lld times;"
+                " each repeat is counted as a separate test.\n",
+                (long long) repeat_ );
+    }
+    if (rejected_ > 0) {
+        printf( "\n%lld points rejected by --where constraints\n",
+                (long long) rejected_ );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// @return routine with given name in routines, or null if not found.
+/// For a single lookup, a linear search is as fast as building an index;
+/// for repeated lookups, use RoutineIndex.
+test_func_ptr find_tester(
+    const char *name,
+    std::vector< routines_t >& routines )
+{
+    for (size_t i = 0; i < routines.size(); ++i) {
+        if (strcmp( name, routines[i].name ) == 0) {
+            return routines[i].func;
+        }
+    }
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+/// @return routine with given name in index, or null if not found.
+test_func_ptr find_tester(
+    const char *name,
+    RoutineIndex const& index )
+{
+    return index.find( name );
+}
+
+// -----------------------------------------------------------------------------
+/// Indexes routines by name. If several routines have the same name,
+/// the index has the first. Empty names, which force a newline in usage,
+/// are skipped.
+RoutineIndex::RoutineIndex( std::vector< routines_t > const& routines )
+{
+    index_.reserve( routines.size() );
+    for (auto const& routine : routines) {
+        if (routine.name[ 0 ] != '\0')
+            index_.emplace( routine.name, routine.func );
+    }
+}
+
+// -----------------------------------------------------------------------------
+/// @return routine with given name, or null if not found.
+test_func_ptr RoutineIndex::find( const char* name ) const
+{
+    auto iter = index_.find( name );
+    if (iter == index_.end())
+        return nullptr;
+    return iter->second;
+}
+
+// -----------------------------------------------------------------------------
+/// @return routines registered by TESTSWEEPER_ROUTINE,
+/// ordered by section, then by registration order within each section.
+std::vector< routines_t >& registered_routines()
+{
+    static std::vector< routines_t > routines;
+    return routines;
+}
+
+// -----------------------------------------------------------------------------
+RegisterRoutine::RegisterRoutine(
+    const char* name, test_func_ptr func, int section )
+{
+    // insert after last routine in same or earlier section
+    auto& routines = registered_routines();
+    auto iter = std::upper_bound(
+        routines.begin(), routines.end(), section,
+        [] (int sec, routines_t const& routine) {
+            return sec < routine.section;
+        } );
+    routines.insert( iter, routines_t{ name, func, section } );
+}
+
+// -----------------------------------------------------------------------------
+/// @return first line of file, e.g., from /sys, without newline;
+/// empty if file can't be read.
+static std::string read_line( const char* filename )
+{
+    std::string line;
+    FILE* file = fopen( filename, "r" );
+    if (file != nullptr) {
+        char buf[ 4096 ];
+        if (fgets( buf, sizeof(buf), file ) != nullptr) {
+            line = buf;
+            while (! line.empty() && isspace( line.back() ))
+                line.pop_back();
+        }
+        fclose( file );
+    }
+    return line;
+}
+
+// -----------------------------------------------------------------------------
+/// Parses list of CPUs or NUMA nodes, e.g., "0-3,8,10-11", as in /sys.
+/// @return sorted list of unique ids.
+static std::vector< int > parse_cpulist( const char* str )
+{
+    std::vector< int > list;
+    const char* pos = str;
+    while (*pos != '\0') {
+        char* end;
+        long first = strtol( pos, &end, 10 );
+        long last  = first;
+        if (end == pos || first < 0)
+            throw_error( "invalid CPU list '%s'", str );
+        pos = end;
+        if (*pos == '-') {
+            last = strtol( pos + 1, &end, 10 );
+            if (end == pos + 1 || last < first)
+                throw_error( "invalid CPU list '%s'", str );
+            pos = end;
+        }
+        for (long id = first; id <= last; ++id)
+            list.push_back( id );
+        if (*pos == ',')
+            ++pos;
+        else if (*pos != '\0')
+            throw_error( "invalid CPU list '%s'", str );
+    }
+    std::sort( list.begin(), list.end() );
+    list.erase( std::unique( list.begin(), list.end() ), list.end() );
+    return list;
+}
+
+// -----------------------------------------------------------------------------
+/// Formats sorted list of ids compactly, e.g., "0-3,8,10-11".
+static std::string format_cpulist( std::vector< int > const& list )
+{
+    std::string str;
+    for (size_t i = 0; i < list.size(); ) {
+        size_t j = i;
+        while (j + 1 < list.size() && list[ j+1 ] == list[ j ] + 1)
+            ++j;
+        if (! str.empty())
+            str += ",";
+        str += std::to_string( list[ i ] );
+        if (j > i)
+            str += "-" + std::to_string( list[ j ] );
+        i = j + 1;
+    }
+    return str.empty() ? "none" : str;
+}
+
+// -----------------------------------------------------------------------------
+/// @return NUMA nodes that have any of given CPUs, as listed in /sys.
+static std::vector< int > numa_nodes( std::vector< int > const& cpus )
+{
+    std::vector< int > nodes;
+    std::string online = read_line( "/sys/devices/system/node/online" );
+    if (online.empty())
+        return nodes;
+    for (int node : parse_cpulist( online.c_str() )) {
+        char path[ 256 ];
+        snprintf( path, sizeof(path),
+                  "/sys/devices/system/node/node%d/cpulist", node );
+        std::string node_cpus = read_line( path );
+        if (node_cpus.empty())
+            continue;
+        for (int cpu : parse_cpulist( node_cpus.c_str() )) {
+            if (std::binary_search( cpus.begin(), cpus.end(), cpu )) {
+                nodes.push_back( node );
+                break;
+            }
+        }
+    }
+    return nodes;
+}
+
+// -----------------------------------------------------------------------------
+/// @return topology id of cpu, e.g., core_id or physical_package_id,
+/// from /sys, or -1 if unknown.
+static int topology_id( int cpu, const char* name )
+{
+    char path[ 256 ];
+    snprintf( path, sizeof(path),
+              "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name );
+    std::string id = read_line( path );
+    return id.empty() ? -1 : atoi( id.c_str() );
+}
+
+// -----------------------------------------------------------------------------
+/// @return CPUs that a process should be bound to for `--bind`:
+/// for cores, one CPU of each physical core, i.e., excluding
+/// hyper-threads; for cores or a CPU list, worker gets its share of the CPUs;
+/// for sockets, worker gets all CPUs of one socket.
+///
+/// @param[in] worker
+///     Index of worker process, in [0, nworkers).
+///
+/// @param[in] nworkers
+///     Number of worker processes sharing the CPUs, or 1.
+///
+std::vector< int > ParamsBase::bind_cpus( int worker, int nworkers ) const
+{
+#ifdef __linux__
+    // CPUs allowed when params was constructed, before binding.
+    if (bind_allowed_.empty())
+        throw_error( "--bind: CPU affinity is unknown" );
+
+    std::vector< int > cpus;
+    if (bind_ == "sockets") {
+        // group allowed CPUs by socket, in order of socket id
+        std::vector< std::pair< int, int > > socket_cpu;
+        for (int cpu : bind_allowed_) {
+            int socket = std::max( topology_id( cpu, "physical_package_id" ), 0 );
+            socket_cpu.push_back( { socket, cpu } );
+        }
+        std::sort( socket_cpu.begin(), socket_cpu.end() );
+        std::vector< int > sockets;
+        for (auto const& sc : socket_cpu) {
+            if (sockets.empty() || sockets.back() != sc.first)
+                sockets.push_back( sc.first );
+        }
+        int socket = sockets[ worker % sockets.size() ];
+        for (auto const& sc : socket_cpu) {
+            if (sc.first == socket)
+                cpus.push_back( sc.second );
+        }
+        std::sort( cpus.begin(), cpus.end() );
+        return cpus;
+    }
+
+    if (bind_ == "cores") {
+        // lowest allowed CPU of each core, identified by socket and core id;
+        // a CPU whose core is unknown is its own core
+        std::set< std::pair< int, int > > cores;
+        for (int cpu : bind_allowed_) {
+            int socket = topology_id( cpu, "physical_package_id" );
+            int core   = topology_id( cpu, "core_id" );
+            if (core < 0) {
+                socket = -1;
+                core   = cpu;
+            }
+            if (cores.insert( { socket, core } ).second)
+                cpus.push_back( cpu );
+        }
+    }
+    else {
+        if (! isdigit( bind_[ 0 ] ))
+            throw_error( "--bind: expected cores, sockets, or CPU list;"
+                         " got '%s'", bind_.c_str() );
+        cpus = parse_cpulist( bind_.c_str() );
+        for (int cpu : cpus) {
+            if (! std::binary_search( bind_allowed_.begin(),
+                                      bind_allowed_.end(), cpu ))
+                throw_error( "--bind: CPU %d is not available", cpu );
+        }
+    }
+
+    // split into nworkers contiguous shares, sizes differing by at most 1
+    int ncpus = cpus.size();
+    if (nworkers >= ncpus)
+        return { cpus[ worker % ncpus ] };
+    int begin = int64_t( worker     ) * ncpus / nworkers;
+    int end   = int64_t( worker + 1 ) * ncpus / nworkers;
+    return std::vector< int >( cpus.begin() + begin, cpus.begin() + end );
+#else
+    throw_error( "--bind is supported only on Linux" );
+    return {};
+#endif
+}
+
+// -----------------------------------------------------------------------------
+/// Binds this process to CPUs for `--bind`, if given; see bind_cpus().
+/// For cores or a CPU list, the main thread and each OpenMP thread, as used
+/// by flush_cache and routines, is bound to its own CPU; for sockets, all
+/// threads may run on any CPU of the socket.
+/// Called by apply() before the first point, and in each child process,
+/// since threads created later inherit the binding of the thread that
+/// creates them.
+///
+/// @param[in] worker
+///     Index of worker process, in [0, nworkers).
+///
+/// @param[in] nworkers
+///     Number of worker processes sharing the CPUs, or 1.
+///
+void ParamsBase::bind( int worker, int nworkers )
+{
+    bind_worker_   = worker;
+    bind_nworkers_ = nworkers;
+    bound_         = true;
+    if (bind_.empty())
+        return;
+
+#ifdef __linux__
+    std::vector< int > cpus = bind_cpus( worker, nworkers );
+    bool per_thread = (bind_ != "sockets");
+    int failed = 0;
+
+    #pragma omp parallel reduction( +: failed )
+    {
+        int tid = 0;
+        #ifdef _OPENMP
+        tid = omp_get_thread_num();
+        #endif
+        cpu_set_t mask;
+        CPU_ZERO( &mask );
+        if (per_thread) {
+            CPU_SET( cpus[ tid % cpus.size() ], &mask );
+        }
+        else {
+            for (int cpu : cpus)
+                CPU_SET( cpu, &mask );
+        }
+        // 0 is the calling thread
+        if (sched_setaffinity( 0, sizeof(mask), &mask ) != 0)
+            failed += 1;
+    }
+    if (failed)
+        throw_error( "--bind: sched_setaffinity failed" );
+#else
+    throw_error( "--bind is supported only on Linux" );
+#endif
+}
+
+// -----------------------------------------------------------------------------
+/// Restores the number of OpenMP threads, and the CPU affinity of this
+/// process and its OpenMP threads, to those when params was constructed,
+/// undoing `--threads` and `--bind`. Used by reset(), so later blocks of
+/// a `--spec` file aren't pinned by earlier ones.
+void ParamsBase::unbind()
+{
+    int nthreads = std::max( threads_current_, threads_default_ );
+    if (threads_current_ > 0) {
+        #ifdef _OPENMP
+        omp_set_num_threads( threads_default_ );
+        #endif
+        threads_current_ = 0;
+    }
+
+    bool bound = bound_;
+    bound_ = false;
+
+#ifdef __linux__
+    if (! bound || bind_.empty() || bind_allowed_.empty())
+        return;
+
+    cpu_set_t mask;
+    CPU_ZERO( &mask );
+    for (int cpu : bind_allowed_)
+        CPU_SET( cpu, &mask );
+    int failed = 0;
+
+    // every thread of the pool, including any beyond the default number
+    #pragma omp parallel num_threads( std::max( nthreads, 1 ) ) \
+        reduction( +: failed )
+    {
+        if (sched_setaffinity( 0, sizeof(mask), &mask ) != 0)
+            failed += 1;
+    }
+    if (failed)
+        throw_error( "--bind: sched_setaffinity failed" );
+#endif
+}
+
+// -----------------------------------------------------------------------------
+/// For `--bind`, prints CPUs and NUMA nodes that the sweep is bound to,
+/// for each worker process with `--workers`.
+void ParamsBase::print_bind()
+{
+    if (bind_.empty())
+        return;
+
+    int nworkers = std::max( workers_, 1 );
+    for (int w = 0; w < nworkers; ++w) {
+        std::vector< int > cpus = bind_cpus( w, nworkers );
+        if (workers_ > 0)
+            printf( "bind %s, worker %d: ", bind_.c_str(), w );
+        else
+            printf( "bind %s: ", bind_.c_str() );
+        printf( "CPUs %s; NUMA nodes %s\n",
+                format_cpulist( cpus ).c_str(),
+                format_cpulist( numa_nodes( cpus ) ).c_str() );
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Memory policy modes, from <numaif.h>, which comes with libnuma;
+// this uses the system calls directly instead.
+enum {
+    mpol_default    = 0,
+    mpol_bind       = 2,
+    mpol_interleave = 3,
+    mpol_local      = 4,
+};
+
+// -----------------------------------------------------------------------------
+/// Gets system call mode and node mask for policy.
+/// For remote, nodes are those with memory that have none of the CPUs
+/// this thread may run on, as set by `--bind`.
+/// Throws error if remote has no such node.
+///
+/// @param[in] policy
+///     Memory policy.
+///
+/// @return placement, for set_mem_policy and mem_alloc.
+///
+MemPlacement mem_placement( MemPolicy policy )
+{
+    MemPlacement placement;
+    placement.policy = policy;
+    if (policy == MemPolicy::Default) {
+        placement.mode = mpol_default;
+        return placement;
+    }
+    if (policy == MemPolicy::Local) {
+        placement.mode = mpol_local;
+        return placement;
+    }
+
+    std::string has_memory = read_line( "/sys/devices/system/node/has_memory" );
+    if (has_memory.empty())
+        has_memory = read_line( "/sys/devices/system/node/online" );
+    if (has_memory.empty())
+        has_memory = "0";
+    std::vector< int > nodes = parse_cpulist( has_memory.c_str() );
+
+    if (policy == MemPolicy::Remote) {
+        std::vector< int > cpus;
+    #ifdef __linux__
+        cpu_set_t cpu_mask;
+        CPU_ZERO( &cpu_mask );
+        if (sched_getaffinity( 0, sizeof(cpu_mask), &cpu_mask ) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET( cpu, &cpu_mask ))
+                    cpus.push_back( cpu );
+            }
+        }
+    #endif
+        std::vector< int > local = numa_nodes( cpus ), remote;
+        std::set_difference( nodes.begin(), nodes.end(),
+                             local.begin(), local.end(),
+                             std::back_inserter( remote ) );
+        if (remote.empty())
+            throw_error( "--mem-policy remote: no NUMA node with memory"
+                         " other than local nodes %s",
+                         format_cpulist( local ).c_str() );
+        nodes = remote;
+    }
+
+    const int bits = 8 * sizeof(unsigned long);
+    auto& mask = placement.mask;
+    mask.resize( nodes.back() / bits + 1 );
+    for (int node : nodes)
+        mask[ node / bits ] |= 1ul << (node % bits);
+    placement.mode = policy == MemPolicy::Remote ? mpol_bind : mpol_interleave;
+    return placement;
+}
+
+// -----------------------------------------------------------------------------
+/// Sets memory policy of the calling thread and of each OpenMP thread,
+/// so memory they first touch follows the policy. Memory from mem_alloc
+/// follows its placement regardless of which thread touches it.
+void set_mem_policy( MemPlacement const& placement )
 {
-    char op, suffix;
-    double x, y;
-    std::complex<double> value;
-    int cnt, bytes1, bytes2, bytes3;
-    cnt = sscanf( *str, "%lf %n %c %n %lf%c %n", &x, &bytes1, &op, &bytes2, &y, &suffix, &bytes3 );
-    if (cnt == 4 && (op == '+' || op == '-') && suffix == 'i') {
-        // x+yi or x-yi complex value
-        if (op == '+')
-            value = std::complex<double>( x, y );
-        else
-            value = std::complex<double>( x, -y );
+#ifdef __linux__
+    auto const& mask = placement.mask;
+    unsigned long maxnode = mask.size() * 8 * sizeof(unsigned long) + 1;
+    int failed = 0;
 
-        *str += bytes3;
-    }
-    else if (cnt == 2 && op == 'i') {
-        // xi imaginary value
-        value = std::complex<double>( 0, x );
-        *str += bytes2;
-    }
-    else if (cnt == 1) {
-        // x real value
-        value = x;
-        *str += bytes1;
-    }
-    else if (cnt > 1 && op == ',') { //handles case of two real values "2.34,1.11", or real and img "2.34,1.11i"
-        // x real value
-        value = x;
-        *str += bytes2 - 1; //leave comma
-    }
-    else {
-        std::string err = std::string("invalid value '") + *str
-                        + "'; expected format like '1.2' or '1.2+3.4i'";
-        throw std::runtime_error( err );
+    #pragma omp parallel reduction( +: failed )
+    {
+        if (syscall( SYS_set_mempolicy, placement.mode,
+                     mask.empty() ? nullptr : mask.data(), maxnode ) != 0)
+            failed += 1;
     }
-    return value;
+    if (failed)
+        throw_error( "set_mempolicy %s failed",
+                     to_string( placement.policy ).c_str() );
+#else
+    if (placement.policy != MemPolicy::Default)
+        throw_error( "--mem-policy is supported only on Linux" );
+#endif
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamComplex::parse( const char *str )
-{
-    //printf("ParamComplex::parse\n");
-    while (true) {
-        std::complex<double> val = scan_complex( &str );
-        TParamBase< std::complex<double> >::push_back( val );
-        if (*str == '\0') {
-            break;
-        }
+// Heap allocation counters, for `--alloc`. Each thread counts in its own
+// cache line, so threads don't contend; threads beyond max_alloc_slots share
+// the last slot. These need only constant initialization, since malloc
+// may be called before static constructors run.
+static const int max_alloc_slots = 256;
 
-        if (*str != ',' && *str != ';') {
-            throw_error( "invalid argument at '%s', expected comma", str );
-        }
-        str += 1;
+struct alignas( 64 ) AllocSlot {
+    std::atomic< int64_t > count;
+    std::atomic< int64_t > bytes;
+};
+
+static AllocSlot s_alloc_slots[ max_alloc_slots ];
+static std::atomic< int >  s_alloc_nslots{ 0 };
+static std::atomic< bool > s_alloc_tracking{ false };
+
+// Default TLS model, so the library can be loaded with dlopen. Executables
+// that link the allocation hooks also link this library at startup, so its
+// TLS is allocated with the thread, and access from malloc doesn't allocate.
+static thread_local int t_alloc_slot = -1;
+
+// -----------------------------------------------------------------------------
+/// Counts one allocation of size bytes by this thread, if tracking is enabled.
+/// Called by mem_alloc, and by the allocation hooks in
+/// testsweeper_alloc_hook.cc, if the executable links them.
+void alloc_count( size_t size )
+{
+    if (! s_alloc_tracking.load( std::memory_order_relaxed ))
+        return;
+    int slot = t_alloc_slot;
+    if (slot < 0) {
+        slot = std::min( s_alloc_nslots.fetch_add( 1, std::memory_order_relaxed ),
+                         max_alloc_slots - 1 );
+        t_alloc_slot = slot;
     }
+    s_alloc_slots[ slot ].count.fetch_add( 1,    std::memory_order_relaxed );
+    s_alloc_slots[ slot ].bytes.fetch_add( size, std::memory_order_relaxed );
 }
 
-//------------------------------------------------------------------------------
-// Output the entire field in a fixed width W,
-// different than the width passed here. W = 2*width + 3,
-// to account for initial -, [+-] between real & complex parts, and i at end.
-// For instance, print calls snprintf_value with width=4, precision=2,
-// and then prints the resulting string in a field width 11 (%-11s).
-//
-template <typename scalar_t>
-const char* snprintf_value(
-    char* buf, size_t buf_len, int width, int precision, scalar_t value)
+// -----------------------------------------------------------------------------
+/// Enables or disables counting heap allocations, for `--alloc`.
+/// Counted are mem_alloc and, if the executable links the allocation hooks
+/// (testsweeper_alloc_hook), malloc, calloc, realloc, posix_memalign,
+/// aligned_alloc, and operator new.
+void alloc_tracking( bool enable )
 {
-    using real_t = real_type<scalar_t>;
+    s_alloc_tracking.store( enable, std::memory_order_relaxed );
+}
 
-    real_t re = std::real( value );
-    real_t im = std::imag( value );
-    if (re == int(re) && im == int(im)) {
-        // exactly integer, print without digits after decimal point
-        if (im != 0) {
-            snprintf(buf, buf_len, "% *.0f%c%.0fi",
-                     width - precision, re,
-                     (im >= 0 ? '+' : '-'),
-                     std::abs(im));
-        }
-        else {
-            snprintf(buf, buf_len, "% *.0f%*s",
-                     width - precision, re, precision, "");
-        }
-    }
-    else {
-        // general case
-        if (im != 0) {
-            snprintf(buf, buf_len, "% *.*f%c%.*fi",
-                     width, precision, re,
-                     (im >= 0 ? '+' : '-'),
-                     precision, std::abs(im));
-        }
-        else {
-            snprintf(buf, buf_len, "% *.*f",
-                     width, precision, re);
-        }
+// -----------------------------------------------------------------------------
+/// @return total heap allocations by all threads while tracking was enabled.
+/// Counts are updated as each allocation happens, so a routine can call this
+/// around a loop to check whether the loop allocates.
+AllocStats alloc_stats()
+{
+    AllocStats stats = { 0, 0 };
+    int nslots = std::min( s_alloc_nslots.load( std::memory_order_relaxed ),
+                           max_alloc_slots );
+    for (int i = 0; i < nslots; ++i) {
+        stats.count += s_alloc_slots[ i ].count.load( std::memory_order_relaxed );
+        stats.bytes += s_alloc_slots[ i ].bytes.load( std::memory_order_relaxed );
     }
-    return buf;
+    return stats;
 }
 
 // -----------------------------------------------------------------------------
-/// If field has been used, prints the value.
-/// If value is set to no_data_flag, it prints "NA".
-/// The output width and precision are set in the constructor.
-// virtual
-void ParamComplex::print() const
+/// Allocates size bytes, placed using mbind. Memory is zeroed.
+/// Allocations of at least mem_alloc_min bytes are page aligned; smaller
+/// ones come from the heap, which follows the thread's memory policy.
+/// Free with mem_free.
+/// Throws std::bad_alloc if allocation fails.
+///
+/// @param[in] size
+///     Bytes to allocate.
+///
+/// @param[in] placement
+///     Placement, from mem_placement(); default leaves placement to the
+///     thread's memory policy.
+///
+void* mem_alloc( size_t size, MemPlacement const& placement )
 {
-    char buf[ 1000 ];
-    if (used_ && display_width_ > 0) {
-        if (same( no_data_flag, values_[ index_ ].real() )) {  //TODO: check also for imaginary?
-            printf( "%*s  ", display_width_, "NA" );
-        }
-        else {
-            snprintf_value( buf, sizeof(buf), display_width_, precision_,
-                            values_[ index_ ] );
-            printf( "%-*s  ", width_, buf);
+    if (size == 0)
+        return nullptr;
+#ifdef __linux__
+    if (size < mem_alloc_min) {
+        void* ptr = calloc( size, 1 );
+        if (ptr == nullptr)
+            throw std::bad_alloc();
+        return ptr;
+    }
+    void* ptr = mmap( nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+    if (ptr == MAP_FAILED)
+        throw std::bad_alloc();
+    alloc_count( size );
+    if (placement.policy != MemPolicy::Default) {
+        auto const& mask = placement.mask;
+        unsigned long maxnode = mask.size() * 8 * sizeof(unsigned long) + 1;
+        if (syscall( SYS_mbind, ptr, size, placement.mode,
+                     mask.empty() ? nullptr : mask.data(), maxnode, 0 ) != 0)
+        {
+            int err = errno;
+            munmap( ptr, size );
+            throw_error( "mbind %s failed: %s",
+                         to_string( placement.policy ).c_str(),
+                         strerror( err ) );
         }
     }
+    return ptr;
+#else
+    void* ptr = calloc( size, 1 );
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    alloc_count( size );
+    return ptr;
+#endif
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamComplex::help() const
+/// Frees memory from mem_alloc. size must be the same as allocated.
+void mem_free( void* ptr, size_t size )
 {
-    if (type_ == ParamType::Value || type_ == ParamType::List) {
-        printf( "    %-16s %s; default ",
-                option_.c_str(), help_.c_str() );
-        if (same( no_data_flag, default_value_.real() )) {
-            printf( "NA\n" );
-        }
-        else {
-            char buf[ 1000 ];
-            snprintf_value( buf, sizeof(buf), display_width_, precision_,
-                            default_value_ );
-            printf( "%s\n", buf );
-        }
-    }
+    if (ptr == nullptr)
+        return;
+#ifdef __linux__
+    if (size < mem_alloc_min)
+        free( ptr );
+    else
+        munmap( ptr, size );
+#else
+    free( ptr );
+#endif
 }
 
-// =============================================================================
-// ParamDouble class
-// Double precision parameter
+// -----------------------------------------------------------------------------
+Workspace::~Workspace()
+{
+    release();
+}
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamDouble::parse( const char *str )
+/// Sets default alignment of buffers from alloc.
+/// Throws error if alignment is not a power of 2.
+void Workspace::alignment( size_t alignment )
 {
-    double start = 0, end = 0, step = 0;
-    while (true) {
-        if (scan_range( &str, &start, &end, &step ) != 0) {
-            throw_error( "invalid argument at '%s', "
-                         "expected float or range start:end:step", str );
-        }
-        if (start == end) {
-            push_back( start );
-        }
-        else {
-            end += step / 10.;  // avoid rounding issues
-            for (double val = start; val <= end; val += step) {
-                push_back( val );
-            }
-        }
-        if (*str == '\0') {
-            break;
-        }
-        if (*str != ',' && *str != ';') {
-            throw_error( "invalid argument at '%s', expected comma", str );
-        }
-        str += 1;
-    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+        throw_error( "alignment %lld must be a power of 2",
+                     (long long) alignment );
+    alignment_ = alignment;
 }
 
 // -----------------------------------------------------------------------------
-void ParamDouble::push_back( double val )
+/// Allocates a chunk of at least bytes, and at least min_chunk,
+/// rounded up to pages or to 2 MiB huge pages.
+void Workspace::add_chunk( size_t bytes )
 {
-    if (val < min_value_ || val > max_value_) {
-        throw_error( "invalid argument, %.*f outside [%.*f, %.*f]",
-                     precision_, val,
-                     precision_, min_value_,
-                     precision_, max_value_ );
+    const size_t page = huge_pages_ ? 2 << 20 : 4096;
+    Chunk chunk;
+    chunk.size = roundup( std::max( bytes, min_chunk ), page );
+    // mem_alloc is page aligned; over-allocate to align to huge pages
+    chunk.base_size = chunk.size + (huge_pages_ ? page : 0);
+    chunk.base = (char*) mem_alloc( chunk.base_size, placement_ );
+    chunk.data = (char*) roundup( uintptr_t( chunk.base ), page );
+#if defined( __linux__ ) && defined( MADV_HUGEPAGE )
+    if (huge_pages_)
+        madvise( chunk.data, chunk.size, MADV_HUGEPAGE );
+#endif
+    if (prefault_) {
+        int64_t pages = chunk.size / 4096;
+        #pragma omp parallel for
+        for (int64_t i = 0; i < pages; ++i)
+            chunk.data[ i*4096 ] = 0;
     }
-    TParamBase<double>::push_back( val );
+    if (poison_)
+        memset( chunk.data, 0xff, chunk.size );
+    chunks_.push_back( chunk );
+    offset_ = 0;
 }
 
 // -----------------------------------------------------------------------------
-/// If field has been used, prints the floating point value.
-/// If value is set to no_data_flag, it prints "NA".
-/// If value < 1, it prints with precision (p) significant digits (%.pg).
-/// Otherwise, it prints with precision (p) digits after the decimal point (%.pf).
-/// The output width and precision are set in the constructor.
-// virtual
-void ParamDouble::print() const
+/// @return buffer of bytes, aligned to alignment bytes, or to alignment()
+/// if 0, valid until the next rewind. If the last chunk is full, adds a
+/// chunk at least as big as the current capacity, so repeated growth is
+/// geometric.
+void* Workspace::alloc_bytes( size_t bytes, size_t alignment )
 {
-    if (used_ && width_ > 0) {
-        if (same( no_data_flag, values_[ index_ ] )) {
-            printf( "%*s  ", width_, "NA" );
-        }
-        else {
-            if (std::abs( values_[ index_ ] ) < 1)
-                printf( "%#*.*g  ", width_, precision_, values_[ index_ ] );
-            else
-                printf( "%*.*f  ", width_, precision_, values_[ index_ ] );
+    if (alignment == 0)
+        alignment = alignment_;
+    else if ((alignment & (alignment - 1)) != 0)
+        throw_error( "alignment %lld must be a power of 2",
+                     (long long) alignment );
+
+    if (! chunks_.empty()) {
+        Chunk& chunk = chunks_.back();
+        uintptr_t data  = uintptr_t( chunk.data );
+        uintptr_t start = roundup( data + offset_, alignment );
+        size_t offset = start - data;
+        if (offset + bytes <= chunk.size) {
+            offset_ = offset + bytes;
+            return (void*) start;
         }
     }
+    add_chunk( std::max( bytes + alignment, capacity() ) );
+    Chunk& chunk = chunks_.back();
+    uintptr_t start = roundup( uintptr_t( chunk.data ), alignment );
+    offset_ = start - uintptr_t( chunk.data ) + bytes;
+    return (void*) start;
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamDouble::help() const
+/// Makes all memory available for the next run. Buffers from previous
+/// allocs become invalid. If the last run added chunks, merges them into
+/// one chunk of the total capacity; with `--poison`, fills memory with 0xff.
+void Workspace::rewind()
 {
-    if (type_ == ParamType::Value || type_ == ParamType::List) {
-        printf( "    %-16s %s; default ",
-                option_.c_str(), help_.c_str() );
-        if (same( no_data_flag, default_value_ )) {
-            printf( "NA\n" );
-        }
-        else {
-            printf( "%.*f\n", precision_, default_value_ );
-        }
+    if (chunks_.size() > 1) {
+        size_t total = capacity();
+        release();
+        add_chunk( total );
+    }
+    else if (poison_ && ! chunks_.empty()) {
+        memset( chunks_[ 0 ].data, 0xff, chunks_[ 0 ].size );
     }
+    offset_ = 0;
 }
 
-// =============================================================================
-// ParamScientific class
-// same as ParamDouble, but prints using scientific notation (%e)
+// -----------------------------------------------------------------------------
+/// Sets placement of chunks, from `--mem-policy`. If the policy changes,
+/// frees all memory, so new chunks are placed by the new policy.
+void Workspace::placement( MemPlacement const& placement )
+{
+    if (placement.policy != placement_.policy)
+        release();
+    placement_ = placement;
+}
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamScientific::print() const
+/// Frees all memory.
+void Workspace::release()
 {
-    if (used_ && width_ > 0) {
-        if (same( no_data_flag, values_[ index_ ] )) {
-            printf( "%*s  ", width_, "NA" );
-        }
-        else {
-            printf( "%*.*e  ", width_, precision_, values_[ index_ ] );
-        }
-    }
+    for (auto& chunk : chunks_)
+        mem_free( chunk.base, chunk.base_size );
+    chunks_.clear();
+    offset_ = 0;
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamScientific::help() const
+size_t Workspace::capacity() const
 {
-    if (type_ == ParamType::Value || type_ == ParamType::List) {
-        printf( "    %-16s %s; default ",
-                option_.c_str(), help_.c_str() );
-        if (same( no_data_flag, default_value_ )) {
-            printf( "NA\n" );
-        }
-        else {
-            printf( "%.*e\n", precision_, default_value_ );
-        }
-    }
+    size_t total = 0;
+    for (auto const& chunk : chunks_)
+        total += chunk.size;
+    return total;
 }
 
-// =============================================================================
-// ParamString class
-// String parameters
+// -----------------------------------------------------------------------------
+/// Samples CPU frequency of the CPU this thread is running on, from
+/// cpufreq in /sys, and context switches and page faults of this process,
+/// from getrusage. Unavailable counters are NaN or 0.
+void ParamsBase::noise_sample( NoiseSample* sample )
+{
+    sample->freq     = no_data_flag;
+    sample->vol_cs   = 0;
+    sample->invol_cs = 0;
+    sample->minflt   = 0;
+    sample->majflt   = 0;
+#ifndef _WIN32
+    struct rusage usage;
+    if (getrusage( RUSAGE_SELF, &usage ) == 0) {
+        sample->vol_cs   = usage.ru_nvcsw;
+        sample->invol_cs = usage.ru_nivcsw;
+        sample->minflt   = usage.ru_minflt;
+        sample->majflt   = usage.ru_majflt;
+    }
+#endif
+#ifdef __linux__
+    int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        char path[ 256 ];
+        snprintf( path, sizeof(path),
+                  "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq",
+                  cpu );
+        std::string khz = read_line( path );
+        if (! khz.empty())
+            sample->freq = atof( khz.c_str() ) / 1000;
+    }
+#endif
+}
 
 // -----------------------------------------------------------------------------
-// Return true if str is in the list of valid strings.
-// If no valid strings are set, always returns true.
-bool ParamString::is_valid( const std::string& str )
+/// Finds RAPL zones under root, e.g., root/intel-rapl:0, one per package.
+/// Subzones, e.g., intel-rapl:0:0 for cores, are skipped since their energy
+/// is part of their package's.
+static std::vector< std::string > rapl_zones( std::string const& root )
 {
-    if (valid_.size() == 0)
-        return true;
-    for (auto iter = valid_.begin(); iter != valid_.end(); ++iter) {
-        if (str == *iter)
-            return true;
+    std::vector< std::string > zones;
+#ifndef _WIN32
+    DIR* dir = opendir( root.c_str() );
+    if (dir == nullptr)
+        return zones;
+    while (struct dirent* entry = readdir( dir )) {
+        const char* name = entry->d_name;
+        const char* colon = strchr( name, ':' );
+        if (strncmp( name, "intel-rapl:", 11 ) == 0
+            && strchr( colon + 1, ':' ) == nullptr)
+        {
+            zones.push_back( root + "/" + name );
+        }
     }
-    return false;
+    closedir( dir );
+    std::sort( zones.begin(), zones.end() );
+#endif
+    return zones;
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamString::parse( const char *str )
+/// Reads energy counter, in microjoules, of each RAPL zone.
+/// @return true if all counters could be read, and there is at least one.
+static bool rapl_read( std::vector< std::string > const& zones,
+                       std::vector< int64_t >* energy )
 {
-    char* copy = strdup( str );
-    char* token = strtok( copy, "," );
-    while (token != nullptr) {
-        push_back( token );
-        token = strtok( nullptr, "," );
+    energy->clear();
+    for (auto const& zone : zones) {
+        std::string uj = read_line( (zone + "/energy_uj").c_str() );
+        if (uj.empty())
+            return false;
+        energy->push_back( strtoll( uj.c_str(), nullptr, 10 ) );
     }
-    free( copy );
+    return ! zones.empty();
 }
 
 // -----------------------------------------------------------------------------
-void ParamString::push_back( const char* str )
+/// @return value in KiB of field, e.g., "VmRSS:", in /proc/self/status,
+/// or -1 if unavailable.
+static int64_t proc_status_kb( const char* field )
 {
-    if (! is_valid(str)) {
-        throw_error( "invalid argument '%s'", str );
+    int64_t kb = -1;
+#ifdef __linux__
+    FILE* file = fopen( "/proc/self/status", "r" );
+    if (file == nullptr)
+        return kb;
+    size_t len = strlen( field );
+    char line[ 256 ];
+    while (fgets( line, sizeof(line), file )) {
+        if (strncmp( line, field, len ) == 0) {
+            kb = strtoll( line + len, nullptr, 10 );
+            break;
+        }
     }
-    TParamBase< std::string >::push_back( str );
+    fclose( file );
+#endif
+    return kb;
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamString::print() const
+/// Starts monitoring the current run, for `--noise`, `--energy`, and `--alloc`.
+/// The framework calls monitor_start() before each run of the routine,
+/// and monitor_stop() after; the routine may call them again around its
+/// timed region to narrow it.
+void ParamsBase::monitor_start()
 {
-    if (used_ && width_ > 0) {
-        printf( "%-*s  ", width_, values_[ index_ ].c_str() );
+    if (! noise_ && ! energy_ && ! alloc_)
+        return;
+    if (noise_)
+        noise_sample( &noise_begin_ );
+    if (energy_) {
+        energy_zones_ = rapl_zones( energy_root_ );
+        energy_begin_ok_ = rapl_read( energy_zones_, &energy_begin_ );
+        energy_power_ = no_data_flag;
+        energy_wtime_ = get_wtime();
+    }
+    if (alloc_) {
+        // Reset peak RSS to current RSS, if allowed (Linux >= 4.0);
+        // else measure growth of the process' peak RSS.
+        FILE* file = fopen( "/proc/self/clear_refs", "w" );
+        bool reset = file != nullptr && fputs( "5", file ) >= 0;
+        if (file != nullptr)
+            reset = (fclose( file ) == 0) && reset;
+        alloc_rss_begin_ = proc_status_kb( reset ? "VmRSS:" : "VmHWM:" );
+        alloc_begin_ = alloc_stats();
     }
+    monitor_running_ = true;
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamString::help() const
+/// Stops monitoring the current run, if running, and sets outputs.
+///
+/// For `--noise`, a run is flagged as disturbed if it had involuntary
+/// context switches or major page faults, or if CPU frequency changed by
+/// more than 10%.
+///
+/// For `--energy`, energy is the sum over RAPL zones of the change in
+/// their counters, which wrap around at max_energy_range_uj.
+/// If counters are missing, energy is no_data_flag.
+///
+/// For `--alloc`, peak RSS is growth of the peak resident set size over
+/// RSS at start, in MiB, from /proc/self/status, or -1 if unavailable;
+/// allocs and alloc bytes count heap allocations by all threads.
+void ParamsBase::monitor_stop()
 {
-    if (type_ == ParamType::Value || type_ == ParamType::List) {
-        printf( "    %-16s %s; default '%s'",
-                option_.c_str(), help_.c_str(),
-                default_value_.c_str() );
-        if (valid_.size() > 0) {
-            printf( "; valid: " );
-            for (auto iter = valid_.begin(); iter != valid_.end(); ++iter) {
-                printf( "%s ", iter->c_str() );
+    if (! monitor_running_)
+        return;
+    monitor_running_ = false;
+
+    if (noise_) {
+        NoiseSample end;
+        noise_sample( &end );
+        NoiseSample const& begin = noise_begin_;
+
+        bool has_freq = ! std::isnan( begin.freq ) && ! std::isnan( end.freq );
+        int64_t invol_cs = end.invol_cs - begin.invol_cs;
+        int64_t majflt   = end.majflt   - begin.majflt;
+        bool disturbed = invol_cs > 0 || majflt > 0
+                       || (has_freq && std::abs( end.freq - begin.freq )
+                                       > 0.1 * begin.freq);
+
+        if (noise_freq_ != nullptr)
+            (*noise_freq_)() = has_freq ? 0.5*(begin.freq + end.freq)
+                                        : no_data_flag;
+        if (noise_vol_cs_ != nullptr)
+            (*noise_vol_cs_)() = end.vol_cs - begin.vol_cs;
+        if (noise_invol_cs_ != nullptr)
+            (*noise_invol_cs_)() = invol_cs;
+        if (noise_minflt_ != nullptr)
+            (*noise_minflt_)() = end.minflt - begin.minflt;
+        if (noise_majflt_ != nullptr)
+            (*noise_majflt_)() = majflt;
+        if (noise_disturbed_ != nullptr)
+            (*noise_disturbed_)() = disturbed;
+    }
+
+    if (energy_) {
+        double time = get_wtime() - energy_wtime_;
+        double energy = no_data_flag;
+        std::vector< int64_t > end;
+        if (energy_begin_ok_ && rapl_read( energy_zones_, &end )) {
+            int64_t uj = 0;
+            for (size_t i = 0; i < end.size(); ++i) {
+                int64_t delta = end[ i ] - energy_begin_[ i ];
+                if (delta < 0) {
+                    // counter wrapped around
+                    std::string range = read_line(
+                        (energy_zones_[ i ] + "/max_energy_range_uj").c_str() );
+                    delta += strtoll( range.c_str(), nullptr, 10 );
+                }
+                uj += delta;
             }
+            energy = uj * 1e-6;
+            if (time > 0)
+                energy_power_ = energy / time;
         }
-        printf( "\n" );
+        if (energy_param_ != nullptr)
+            (*energy_param_)() = energy;
+    }
+
+    if (alloc_) {
+        AllocStats end = alloc_stats();
+        int64_t peak = proc_status_kb( "VmHWM:" );
+        if (alloc_peak_rss_ != nullptr && peak >= 0 && alloc_rss_begin_ >= 0) {
+            // KiB to MiB, rounded
+            (*alloc_peak_rss_)() =
+                (std::max( peak - alloc_rss_begin_, int64_t( 0 ) ) + 512) / 1024;
+        }
+        if (alloc_count_ != nullptr)
+            (*alloc_count_)() = end.count - alloc_begin_.count;
+        if (alloc_bytes_ != nullptr)
+            (*alloc_bytes_)() = end.bytes - alloc_begin_.bytes;
     }
 }
 
 // -----------------------------------------------------------------------------
-// Set the allowed strings
-void ParamString::add_valid( const char* str )
+/// Called by the framework after each run of the routine, in the process
+/// that ran it: stops monitoring, if the routine didn't, and sets Gflop/J
+/// from the average power of the monitored region, for `--energy`.
+///
+/// @param[in] gflops
+///     Gflop/s rate of current run, read without marking gflops used,
+///     e.g., std::as_const( params ).gflops().
+///
+void ParamsBase::monitor_finish( double gflops )
 {
-    valid_.push_back( str );
+    monitor_stop();
+    if (gflop_per_joule_ != nullptr && energy_power_ > 0
+        && ! std::isnan( gflops ))
+    {
+        (*gflop_per_joule_)() = gflops / energy_power_;
+    }
 }
 
 // -----------------------------------------------------------------------------
-// for line=0, print blanks
-// for line=1, print name (left aligned)
-// virtual
-void ParamString::header( int line ) const
+/// Writes all len bytes of buf to fd.
+/// @return true on success.
+static bool write_all( int fd, const void* buf, size_t len )
 {
-    if (used_ && width_ > 0) {
-        printf( "%-*s  ", width_, (line == 0 ? "" : name_.c_str()) );
+#ifndef _WIN32
+    const char* pos = (const char*) buf;
+    while (len > 0) {
+        ssize_t cnt = write( fd, pos, len );
+        if (cnt < 0 && errno == EINTR)
+            continue;
+        if (cnt <= 0)
+            return false;
+        pos += cnt;
+        len -= cnt;
     }
+    return true;
+#else
+    return false;
+#endif
 }
 
-// =============================================================================
-// ParamChar class
-// Character parameters
-
 // -----------------------------------------------------------------------------
-// virtual
-void ParamChar::parse( const char *str )
+/// Reads exactly len bytes from fd into buf.
+/// @return true on success; false on end-of-file or error.
+static bool read_all( int fd, void* buf, size_t len )
 {
-    while (true) {
-        char val;
-        int len;
-        int i = sscanf( str, "%c %n", &val, &len );
-        if (i != 1) {
-            throw_error( "invalid argument at '%s', expected one char", str );
-        }
-        str += len;
-        push_back( val );
-        if (*str == '\0') {
-            break;
-        }
-        if (*str != ',' && *str != ';') {
-            throw_error( "invalid argument at '%s', expected comma", str );
-        }
-        str += 1;
+#ifndef _WIN32
+    char* pos = (char*) buf;
+    while (len > 0) {
+        ssize_t cnt = read( fd, pos, len );
+        if (cnt < 0 && errno == EINTR)
+            continue;
+        if (cnt <= 0)
+            return false;
+        pos += cnt;
+        len -= cnt;
     }
+    return true;
+#else
+    return false;
+#endif
 }
 
 // -----------------------------------------------------------------------------
-void ParamChar::push_back( char val )
+/// Closes pipes and, in parent, waits for child if finish() wasn't called.
+Isolate::~Isolate()
 {
-    if (valid_.find( val ) == std::string::npos) {  // not found
-        throw_error( "invalid option, %c not in [%s]", val, valid_.c_str() );
-    }
-    TParamBase<char>::push_back( val );
+    if (pid_ > 0)
+        finish();
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamChar::print() const
+/// Forks child process connected to this one by a pair of pipes:
+/// one for results from child, one for point indices from parent.
+/// Output is flushed first, so buffered output isn't duplicated.
+///
+/// @return true in child; false in parent.
+bool Isolate::fork()
 {
-    if (used_ && width_ > 0) {
-        printf( "%*c  ", width_, values_[ index_ ] );
+#ifdef _WIN32
+    throw_error( "--isolate and --workers are not supported on Windows" );
+    return false;
+#else
+    int fd[ 2 ], cmd[ 2 ];
+    if (pipe( fd ) != 0)
+        throw_error( "pipe failed: %s", strerror( errno ) );
+    if (pipe( cmd ) != 0) {
+        close( fd[ 0 ] );
+        close( fd[ 1 ] );
+        throw_error( "pipe failed: %s", strerror( errno ) );
+    }
+
+    fflush( stdout );
+    fflush( stderr );
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        close( fd[ 0 ] );
+        close( fd[ 1 ] );
+        close( cmd[ 0 ] );
+        close( cmd[ 1 ] );
+        throw_error( "fork failed: %s", strerror( errno ) );
+    }
+    if (pid == 0) {
+        // child writes results, reads commands
+        close( fd[ 0 ] );
+        close( cmd[ 1 ] );
+        fd_ = fd[ 1 ];
+        cmd_fd_ = cmd[ 0 ];
+        pid_ = 0;
+        return true;
     }
+    // parent reads results, writes commands
+    close( fd[ 1 ] );
+    close( cmd[ 0 ] );
+    fd_ = fd[ 0 ];
+    cmd_fd_ = cmd[ 1 ];
+    pid_ = pid;
+    return false;
+#endif
 }
 
 // -----------------------------------------------------------------------------
-// virtual
-void ParamChar::help() const
+/// In child, closes this object's pipes, which were inherited from the
+/// parent's connection to another child, without waiting for that child.
+/// Otherwise, that child wouldn't see end-of-file when the parent finishes it.
+void Isolate::detach()
 {
-    if (type_ == ParamType::Value || type_ == ParamType::List) {
-        printf( "    %-16s %s; default %c; valid: [%s]\n",
-                option_.c_str(), help_.c_str(),
-                default_value_, valid_.c_str() );
-    }
+#ifndef _WIN32
+    if (fd_ >= 0)
+        close( fd_ );
+    if (cmd_fd_ >= 0)
+        close( cmd_fd_ );
+#endif
+    fd_ = -1;
+    cmd_fd_ = -1;
+    pid_ = -1;
 }
 
-// =============================================================================
-// ParamsBase class
-// List of parameters
-
 // -----------------------------------------------------------------------------
-/// Throws QuitException if --help is encountered.
-/// Throws std::runtime_error for errors.
-void ParamsBase::parse( const char *routine, int n, char **args )
+/// In parent, sends index of the next point for child to run.
+void Isolate::assign( int64_t point )
 {
-    // Usage: test [params] command
-    for (int i = 0; i < n; ++i) {
-        const char *arg = args[i];
-        size_t len = strlen( arg );
-        try {
-            bool found = false;
-            if (strncmp( arg, "-h", 2 ) == 0 ||
-                strncmp( arg, "--help", 6 ) == 0)
-            {
-                throw QuitException();
-            }
-            for (auto param  = ParamBase::s_params.begin();
-                      param != ParamBase::s_params.end();
-                    ++param)
-            {
-                // handles both "--option value" (two arg)
-                // and          "--option=value" (one arg)
-                size_t plen = (*param)->option_.size();
-                if ((len == plen || (len >= plen && arg[plen] == '=')) &&
-                    strncmp( arg, (*param)->option_.c_str(), plen ) == 0)
-                {
-                    if (! (*param)->used()) {
-                        throw_error( "invalid parameter for routine '%s'",
-                                     routine );
-                    }
-                    const char *value = nullptr;
-                    if (len == plen && i+1 < n) {
-                        // --arg value (two arguments)
-                        i += 1;
-                        value = args[i];
-                    }
-                    else if (len > plen+1 && arg[plen] == '=') {
-                        // --arg=value (one argument)
-                        value = arg + (*param)->option_.size() + 1;
-                    }
-                    else {
-                        throw_error( "requires an argument" );
-                    }
-                    (*param)->parse( value );
-                    found = true;
-                    break;
-                }
-            }
-            if (! found) {
-                throw_error( "invalid parameter" );
-            }
-        }
-        // QuitException is not a runtime_error,
-        // so it is caught at a higher level.
-        catch (const std::runtime_error& ex) {
-            // prepend arg to error message
-            throw std::runtime_error( std::string(arg) + ": " + ex.what() );
-        }
-    }
+    if (! write_all( cmd_fd_, &point, sizeof(point) ))
+        throw_error( "write to worker failed: %s", strerror( errno ) );
 }
 
 // -----------------------------------------------------------------------------
-bool ParamsBase::next()
+/// In child, receives index of the next point to run.
+/// @return true on success; false if parent has finished with this child.
+bool Isolate::receive_point( int64_t* point )
 {
-    // "Cartesian product" iteration
-    // uses reverse order so in output, parameters on right cycle fastest
-    for (auto param = ParamBase::s_params.rbegin();
-         param != ParamBase::s_params.rend(); ++param)
-    {
-        if ((*param)->next()) {
-            return true;
-        }
-    }
-    return false;
+    return read_all( cmd_fd_, point, sizeof(*point) );
 }
 
 // -----------------------------------------------------------------------------
-void ParamsBase::header()
+/// In parent, waits until one of the children has results to receive,
+/// or has exited.
+///
+/// @param[in] children
+///     Children to wait for; null entries and finished children are ignored.
+///
+/// @return index in children of a child that is ready.
+///
+size_t Isolate::poll( std::vector< std::unique_ptr< Isolate > > const& children )
 {
-    for (int line = 0; line < 2; ++line) {
-        for (auto param  = ParamBase::s_params.begin();
-                  param != ParamBase::s_params.end();
-                ++param)
-        {
-            (*param)->header( line );
+#ifdef _WIN32
+    throw_error( "--workers is not supported on Windows" );
+    return 0;
+#else
+    std::vector< pollfd > fds;
+    std::vector< size_t > index;
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (children[ i ] && children[ i ]->fd_ >= 0) {
+            fds.push_back( { children[ i ]->fd_, POLLIN, 0 } );
+            index.push_back( i );
         }
-        printf( "\n" );
     }
+    if (fds.empty())
+        throw_error( "no workers to wait for" );
+
+    while (::poll( fds.data(), fds.size(), -1 ) < 0) {
+        if (errno != EINTR)
+            throw_error( "poll failed: %s", strerror( errno ) );
+    }
+    for (size_t k = 0; k < fds.size(); ++k) {
+        if (fds[ k ].revents != 0)
+            return index[ k ];
+    }
+    throw_error( "poll returned no ready workers" );
+    return 0;
+#endif
 }
 
 // -----------------------------------------------------------------------------
-void ParamsBase::print()
+/// In child, sends error message and packed outputs of one run to parent.
+void Isolate::send( std::string const& error, std::string const& outputs )
 {
-    for (auto param  = ParamBase::s_params.begin();
-              param != ParamBase::s_params.end();
-            ++param)
+    // Flush routine's output before parent prints the result.
+    fflush( stdout );
+    fflush( stderr );
+    uint64_t len[ 2 ] = { error.size(), outputs.size() };
+    if (! write_all( fd_, len, sizeof(len) )
+        || ! write_all( fd_, error.data(), error.size() )
+        || ! write_all( fd_, outputs.data(), outputs.size() ))
     {
-        (*param)->print();
+        exit();
     }
-    printf( "\n" );
 }
 
 // -----------------------------------------------------------------------------
-void ParamsBase::reset_output()
+/// In child, flushes output and exits without running destructors or
+/// atexit handlers, which belong to the parent.
+void Isolate::exit()
 {
-    for (auto param  = ParamBase::s_params.begin();
-              param != ParamBase::s_params.end();
-            ++param)
-    {
-        (*param)->reset_output();
-    }
+#ifndef _WIN32
+    fflush( stdout );
+    fflush( stderr );
+    close( fd_ );
+    close( cmd_fd_ );
+    _exit( 0 );
+#endif
+    std::abort();
 }
 
 // -----------------------------------------------------------------------------
-void ParamsBase::help( const char *routine )
+/// In parent, receives error message and packed outputs of one run.
+/// @return true on success; false if child exited or crashed.
+bool Isolate::receive( std::string* error, std::string* outputs )
 {
-    // todo: pass in argv[0] instead of assuming test.
-    printf( "%sUsage:%s test [-h|--help]\n"
-            "       test [-h|--help] routine\n"
-            "       test [parameters] routine\n\n"
-            "%sParameters for %s:%s\n",
-            ansi_bold, ansi_normal,
-            ansi_bold, routine, ansi_normal );
-    for (auto param  = ParamBase::s_params.begin();
-              param != ParamBase::s_params.end();
-            ++param)
-    {
-        if ((*param)->used_ && (*param)->type_ == ParamType::Value)
-            (*param)->help();
+    uint64_t len[ 2 ];
+    if (! read_all( fd_, len, sizeof(len) ))
+        return false;
+    error->resize( len[ 0 ] );
+    outputs->resize( len[ 1 ] );
+    return read_all( fd_, &(*error)[ 0 ], len[ 0 ] )
+        && read_all( fd_, &(*outputs)[ 0 ], len[ 1 ] );
+}
+
+// -----------------------------------------------------------------------------
+/// In parent, closes pipes and waits for child to exit.
+/// A worker child waiting for a point exits when its pipe is closed.
+/// @return description of how child exited, e.g.,
+/// "crashed with signal 11 (Segmentation fault)",
+/// or "exited before finishing" if it exited normally.
+std::string Isolate::finish()
+{
+    std::string result;
+#ifndef _WIN32
+    if (fd_ >= 0) {
+        close( fd_ );
+        fd_ = -1;
     }
-    printf( "\n%sParameters that take comma-separated list of values and may be repeated:%s\n",
-            ansi_bold, ansi_normal );
-    for (auto param  = ParamBase::s_params.begin();
-              param != ParamBase::s_params.end();
-            ++param)
-    {
-        if ((*param)->used_ && (*param)->type_ == ParamType::List)
-            (*param)->help();
+    if (cmd_fd_ >= 0) {
+        close( cmd_fd_ );
+        cmd_fd_ = -1;
+    }
+    if (pid_ > 0) {
+        int status = 0;
+        while (waitpid( pid_t( pid_ ), &status, 0 ) < 0 && errno == EINTR) {}
+        pid_ = -1;
+        char buf[ 256 ];
+        if (WIFSIGNALED( status )) {
+            snprintf( buf, sizeof(buf), "crashed with signal %d (%s)",
+                      WTERMSIG( status ), strsignal( WTERMSIG( status ) ) );
+            result = buf;
+        }
+        else if (WIFEXITED( status ) && WEXITSTATUS( status ) != 0) {
+            snprintf( buf, sizeof(buf), "exited with status %d",
+                      WEXITSTATUS( status ) );
+            result = buf;
+        }
+        else {
+            result = "exited before finishing";
+        }
     }
+#endif
+    return result;
 }
 
 // -----------------------------------------------------------------------------
-test_func_ptr find_tester(
-    const char *name,
-    std::vector< routines_t >& routines )
+/// Loads a shared library of test routines into the tester, so routines can
+/// be added without relinking the tester.
+/// Routines that the plugin registers with TESTSWEEPER_ROUTINE are
+/// appended to routines. Then, if the plugin exports
+///
+///     extern "C" void testsweeper_plugin(
+///         std::vector< testsweeper::routines_t >& routines,
+///         testsweeper::ParamsBase& params );
+///
+/// it is called to add more routines, and the plugin's own parameters
+/// to params using params.add(). The plugin must be compiled with the
+/// application's Params class and linked with the shared TestSweeper library.
+/// Plugins are never unloaded.
+///
+/// @param[in] filename
+///     Shared library to load, passed to dlopen.
+///
+/// @param[in,out] routines
+///     Application's table of routines, to add plugin's routines to.
+///
+/// @param[in,out] params
+///     Application's parameters, to add plugin's parameters to.
+///
+void load_plugin(
+    const char* filename,
+    std::vector< routines_t >& routines,
+    ParamsBase& params )
 {
-    for (size_t i = 0; i < routines.size(); ++i) {
-        if (strcmp( name, routines[i].name ) == 0) {
-            return routines[i].func;
-        }
+#ifdef _WIN32
+    throw_error( "%s: plugins are not supported on Windows", filename );
+#else
+    // Collect routines registered by plugin's static initializers,
+    // then restore previously registered routines.
+    std::vector< routines_t > saved;
+    std::swap( saved, registered_routines() );
+
+    void* handle = dlopen( filename, RTLD_NOW | RTLD_LOCAL );
+
+    std::vector< routines_t > added;
+    std::swap( added, registered_routines() );
+    std::swap( saved, registered_routines() );
+    if (handle == nullptr) {
+        throw_error( "can't load plugin: %s", dlerror() );
     }
-    return nullptr;
+    for (auto const& routine : added) {
+        RegisterRoutine( routine.name, routine.func, routine.section );
+    }
+    routines.insert( routines.end(), added.begin(), added.end() );
+
+    auto func = (plugin_func_ptr) dlsym( handle, "testsweeper_plugin" );
+    if (func != nullptr) {
+        func( routines, params );
+    }
+    else if (added.empty()) {
+        throw_error( "%s: plugin has no routines", filename );
+    }
+#endif
 }
 
 // -----------------------------------------------------------------------------
@@ -1294,4 +5761,89 @@ double get_wtime()
     #endif
 }
 
+// -----------------------------------------------------------------------------
+/// Reads sweep specification file for `--spec`.
+/// Each non-blank line is one block of arguments, `[parameters] routine`,
+/// the same as would be given on the command line.
+/// A line ending in backslash is continued on the next line.
+/// Text after # is a comment. Arguments are separated by whitespace,
+/// and may be quoted with single or double quotes.
+///
+/// @param[in] filename
+///     Name of specification file.
+///
+/// @return list of blocks, each a list of arguments.
+///
+std::vector< std::vector< std::string > > read_spec( const char* filename )
+{
+    FILE* file = fopen( filename, "r" );
+    if (file == nullptr)
+        throw_error( "cannot open spec file '%s'", filename );
+
+    std::vector< std::vector< std::string > > blocks;
+    std::vector< std::string > args;
+    std::string arg;
+    bool in_arg = false;
+    char quote = '\0';
+    int line = 1;
+    int c;
+    while (true) {
+        c = fgetc( file );
+        if (quote != '\0') {
+            // inside quotes, take everything up to closing quote
+            if (c == EOF || c == '\n') {
+                fclose( file );
+                throw_error( "%s:%d: unterminated quote", filename, line );
+            }
+            if (c == quote)
+                quote = '\0';
+            else
+                arg += char( c );
+            continue;
+        }
+        if (c == '\\') {
+            int c2 = fgetc( file );
+            if (c2 == '\n') {
+                // line continuation
+                line += 1;
+                c = ' ';
+            }
+            else {
+                ungetc( c2, file );
+            }
+        }
+        if (c == '#') {
+            // skip comment
+            do {
+                c = fgetc( file );
+            } while (c != '\n' && c != EOF);
+        }
+        if (c == EOF || isspace( c )) {
+            if (in_arg) {
+                args.push_back( arg );
+                arg.clear();
+                in_arg = false;
+            }
+            if ((c == EOF || c == '\n') && ! args.empty()) {
+                blocks.push_back( args );
+                args.clear();
+            }
+            if (c == EOF)
+                break;
+            if (c == '\n')
+                line += 1;
+        }
+        else if (c == '\'' || c == '"') {
+            quote  = c;
+            in_arg = true;
+        }
+        else {
+            arg += char( c );
+            in_arg = true;
+        }
+    }
+    fclose( file );
+    return blocks;
+}
+
 } // namespace testsweeper
@@ -6,6 +6,7 @@
 #ifndef LIBTEST_HH
 #define LIBTEST_HH
 
+#include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <stdint.h>
@@ -18,6 +19,10 @@
 #include <complex>
 #include <type_traits>
 #include <numeric>
+#include <unordered_map>
+#include <functional>
+#include <memory>
+#include <utility>
 
 // Version is updated by make_release.py; DO NOT EDIT.
 // Version 2025.05.28
@@ -149,6 +154,43 @@ inline std::string to_string( DataType value )
     return std::string( to_c_string( value ) );
 }
 
+// -----------------------------------------------------------------------------
+/// NUMA memory placement, applied with `--mem-policy`.
+enum class MemPolicy {
+    Default,     ///< leave as is: usually first touch
+    Local,       ///< on node of CPU that allocates
+    Interleave,  ///< round-robin over all nodes with memory
+    Remote,      ///< on nodes other than those of CPUs the process runs on
+};
+
+extern const char* MemPolicy_help;
+
+//----------------------------------------
+/// Convert string to MemPolicy enum.
+inline void from_string( std::string const& str, MemPolicy* val )
+{
+    if      (str == "default"   ) *val = MemPolicy::Default;
+    else if (str == "local"     ) *val = MemPolicy::Local;
+    else if (str == "interleave") *val = MemPolicy::Interleave;
+    else if (str == "remote"    ) *val = MemPolicy::Remote;
+    else
+        throw_error( "invalid memory policy '%s'", str.c_str() );
+}
+
+//----------------------------------------
+/// Convert MemPolicy enum to string.
+inline std::string to_string( MemPolicy value )
+{
+    switch (value) {
+        case MemPolicy::Default:    return "default";
+        case MemPolicy::Local:      return "local";
+        case MemPolicy::Interleave: return "interleave";
+        case MemPolicy::Remote:     return "remote";
+    }
+    throw_error( "invalid memory policy" );
+    return "?";
+}
+
 
 //==============================================================================
 // Utilities
@@ -206,9 +248,223 @@ public:
 // -----------------------------------------------------------------------------
 int scan_range( const char **strp, int64_t *start, int64_t *end, int64_t *step );
 int scan_range( const char **strp, double  *start, double  *end, double  *step );
+int scan_range( const char **strp, int64_t *start, int64_t *end, int64_t *step,
+                double *ratio );
+int scan_range( const char **strp, double  *start, double  *end, double  *step,
+                double *ratio );
+
+void append_range( std::vector< int64_t >& values,
+                   int64_t start, int64_t end, int64_t step, double ratio );
+void append_range( std::vector< double >& values,
+                   double start, double end, double step, double ratio );
 
 void flush_cache( size_t cache_size );
 
+// -----------------------------------------------------------------------------
+// Counter-based random fill; see random_fill( int64_t, double*, ... ).
+void random_fill( int64_t n, float*  x, uint64_t seed, uint64_t key,
+                  int64_t offset=0 );
+void random_fill( int64_t n, double* x, uint64_t seed, uint64_t key,
+                  int64_t offset=0 );
+void random_fill( int64_t n, std::complex<float>*  x,
+                  uint64_t seed, uint64_t key, int64_t offset=0 );
+void random_fill( int64_t n, std::complex<double>* x,
+                  uint64_t seed, uint64_t key, int64_t offset=0 );
+void random_fill( int64_t n, int64_t* x, uint64_t seed, uint64_t key,
+                  int64_t offset=0 );
+void random_fill( DataType type, int64_t n, void* x,
+                  uint64_t seed, uint64_t key, int64_t offset=0 );
+
+// -----------------------------------------------------------------------------
+/// Differences between a result x and reference y, from difference().
+/// If x or y has NaN, max_abs, max_rel, and norm are NaN.
+struct Difference {
+    double  max_abs;  ///< max_i | x_i - y_i |
+    double  max_rel;  ///< max_i | x_i - y_i | / | y_i |, absolute if y_i = 0
+    double  norm;     ///< || x - y ||_2 / || y ||_2, absolute if y = 0
+    int64_t max_ulp;  ///< max ULP distance, of real and imaginary parts
+    int64_t first;    ///< index of first mismatch, or -1 if x == y
+};
+
+Difference difference( int64_t n, float const*  x, float const*  y );
+Difference difference( int64_t n, double const* x, double const* y );
+Difference difference( int64_t n, std::complex<float> const*  x,
+                       std::complex<float> const*  y );
+Difference difference( int64_t n, std::complex<double> const* x,
+                       std::complex<double> const* y );
+Difference difference( int64_t n, int64_t const* x, int64_t const* y );
+Difference difference( DataType type, int64_t n,
+                       void const* x, void const* y );
+
+// -----------------------------------------------------------------------------
+/// NUMA memory placement for a memory policy: the mode and node mask for
+/// set_mempolicy and mbind. Computing the mask reads /sys and the CPU
+/// affinity, so it is done once per policy by mem_placement(), not for
+/// each allocation; see `--mem-policy`.
+struct MemPlacement {
+    MemPolicy policy = MemPolicy::Default;
+    int mode = 0;
+    std::vector< unsigned long > mask;  ///< empty for default and local
+};
+
+MemPlacement mem_placement( MemPolicy policy );
+void set_mem_policy( MemPlacement const& placement );
+void* mem_alloc( size_t size, MemPlacement const& placement = {} );
+void  mem_free( void* ptr, size_t size );
+
+/// Allocations smaller than this come from the heap, which follows the
+/// thread's memory policy, instead of their own pages placed by mbind.
+const size_t mem_alloc_min = 64 << 10;  ///< 64 KiB
+
+//------------------------------------------------------------------------------
+/// Allocator that places memory by a memory policy, usually
+/// params.mem_placement() as set by `--mem-policy`, regardless of which
+/// thread first touches it, e.g.,
+///
+///     using Alloc = testsweeper::MemAllocator< double >;
+///     std::vector< double, Alloc > x( n, Alloc( params.mem_placement() ) );
+///
+/// The placement must outlive the allocator. A default allocator uses the
+/// default policy.
+template <typename T>
+class MemAllocator
+{
+public:
+    using value_type = T;
+
+    MemAllocator() = default;
+
+    explicit MemAllocator( MemPlacement const& placement ):
+        placement_( &placement )
+    {}
+
+    template <typename U>
+    MemAllocator( MemAllocator<U> const& other ):
+        placement_( other.placement() )
+    {}
+
+    T* allocate( size_t n )
+    {
+        return (T*) (placement_ ? mem_alloc( n * sizeof(T), *placement_ )
+                                : mem_alloc( n * sizeof(T) ));
+    }
+
+    void deallocate( T* ptr, size_t n )
+    {
+        mem_free( ptr, n * sizeof(T) );
+    }
+
+    MemPlacement const* placement() const { return placement_; }
+
+private:
+    MemPlacement const* placement_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator == ( MemAllocator<T> const& a, MemAllocator<U> const& b )
+{
+    return a.placement() == b.placement();
+}
+
+template <typename T, typename U>
+bool operator != ( MemAllocator<T> const& a, MemAllocator<U> const& b )
+{
+    return ! (a == b);
+}
+
+// -----------------------------------------------------------------------------
+/// Heap allocations counted while tracking is enabled; see `--alloc`.
+struct AllocStats {
+    int64_t count;  ///< number of allocations
+    int64_t bytes;  ///< bytes requested
+};
+
+void alloc_tracking( bool enable );
+void alloc_count( size_t size );
+AllocStats alloc_stats();
+
+//------------------------------------------------------------------------------
+/// Arena for test buffers, from params.workspace(), reused across runs and
+/// sweep points so allocation and page faults stay out of the timed region.
+/// Within a run, each alloc returns a new aligned buffer; the framework
+/// rewinds the arena before each run, e.g.,
+///
+///     double* x = params.workspace().alloc< double >( n );
+///
+/// Memory comes from mem_alloc, so follows placement(), which the framework
+/// sets from `--mem-policy`. The arena grows
+/// monotonically: if a run needs more than its capacity, extra chunks are
+/// added for that run, then merged into one larger chunk at the next rewind.
+/// Options are set by `--align`, `--huge-pages`, `--prefault`, and `--poison`.
+class Workspace
+{
+public:
+    Workspace() = default;
+    ~Workspace();
+
+    Workspace( Workspace const& ) = delete;
+    Workspace& operator = ( Workspace const& ) = delete;
+
+    void* alloc_bytes( size_t bytes, size_t alignment=0 );
+
+    /// @return buffer of n elements of type T, aligned to alignment bytes,
+    /// or to alignment() if 0. Contents are unspecified: zero on first use,
+    /// left over from previous runs, or poisoned with `--poison`.
+    template <typename T>
+    T* alloc( int64_t n, size_t alignment=0 )
+    {
+        return (T*) alloc_bytes( n * sizeof(T), alignment );
+    }
+
+    void rewind();
+    void release();
+
+    /// @return total bytes allocated in all chunks.
+    size_t capacity() const;
+
+    /// Sets default alignment in bytes, a power of 2; default 64.
+    void   alignment( size_t alignment );
+    size_t alignment() const { return alignment_; }
+
+    /// With huge pages, chunks are 2 MiB aligned and advised to use
+    /// transparent huge pages.
+    void huge_pages( bool enable ) { huge_pages_ = enable; }
+    bool huge_pages() const { return huge_pages_; }
+
+    /// With prefault, pages of new chunks are touched when allocated.
+    void prefault( bool enable ) { prefault_ = enable; }
+    bool prefault() const { return prefault_; }
+
+    /// With poison, memory is filled with 0xff bytes (NaN for floating
+    /// point types) when allocated and at each rewind.
+    void poison( bool enable ) { poison_ = enable; }
+    bool poison() const { return poison_; }
+
+    void placement( MemPlacement const& placement );
+    MemPlacement const& placement() const { return placement_; }
+
+    static constexpr size_t min_chunk = 1 << 20;  ///< 1 MiB
+
+private:
+    void add_chunk( size_t bytes );
+
+    /// Memory from mem_alloc; data is start of chunk, aligned for huge pages.
+    struct Chunk {
+        char*  base;
+        size_t base_size;
+        char*  data;
+        size_t size;
+    };
+
+    std::vector< Chunk > chunks_;
+    MemPlacement placement_;
+    size_t offset_     = 0;  ///< bytes used in last chunk
+    size_t alignment_  = 64;
+    bool   huge_pages_ = false;
+    bool   prefault_   = false;
+    bool   poison_     = false;
+};
+
 // -----------------------------------------------------------------------------
 /// For integers x >= 0, y > 0, returns ceil( x/y ).
 /// For x == 0, this is 0.
@@ -246,6 +502,87 @@ enum class ParamType
     List,
 };
 
+// =============================================================================
+// Compile-time parameter schema.
+// A numeric parameter can be declared in a constexpr table of ParamSpec,
+// which is validated by static_assert( spec_valid( table ) ), and looked up by
+// name with spec_find, so a misspelled name is a compile error, e.g.,
+//
+//     constexpr ParamSpec specs[] = {
+//         // name,   w, p, type,            default, min,  max, help
+//         { "nb",    4, 0, ParamType::List,     384,   0,  1e6, "block size" },
+//     };
+//     static_assert( spec_valid( specs ), "invalid parameter schema" );
+//     ParamInt nb( spec_find( specs, "nb" ) );
+//
+// Accessors are unchanged, inline loads from the parameter's values.
+
+struct ParamSpec
+{
+    const char* name;
+    int         width;
+    int         precision;  ///< digits after the decimal point; 0 for ParamInt
+    ParamType   type;
+    double      default_value;
+    double      min_value;
+    double      max_value;
+    const char* help;
+};
+
+//----------------------------------------
+/// @return true if strings a and b are equal; usable in constant expressions.
+constexpr bool str_equal( const char* a, const char* b )
+{
+    while (*a != '\0' && *a == *b) {
+        ++a;
+        ++b;
+    }
+    return *a == *b;
+}
+
+//----------------------------------------
+/// @return true if every parameter in specs has a valid, unique name
+/// without spaces, a non-negative width and precision, and,
+/// for non-output parameters, min_value <= default_value <= max_value.
+template <size_t N>
+constexpr bool spec_valid( ParamSpec const (&specs)[ N ] )
+{
+    for (size_t i = 0; i < N; ++i) {
+        ParamSpec const& spec = specs[ i ];
+        if (spec.name == nullptr || spec.help == nullptr
+            || spec.width < 0 || spec.precision < 0)
+            return false;
+        for (const char* c = spec.name; *c != '\0'; ++c) {
+            if (*c == ' ' || *c == '=')
+                return false;
+        }
+        if (spec.type != ParamType::Output
+            && ! (spec.min_value <= spec.default_value
+                  && spec.default_value <= spec.max_value))
+            return false;
+        for (size_t j = 0; j < i; ++j) {
+            if (str_equal( specs[ j ].name, spec.name ))
+                return false;
+        }
+    }
+    return true;
+}
+
+//----------------------------------------
+/// @return parameter in specs with given name.
+/// In a constant expression, an unknown name is a compile error;
+/// at runtime, throws std::out_of_range.
+template <size_t N>
+constexpr ParamSpec const& spec_find(
+    ParamSpec const (&specs)[ N ], const char* name )
+{
+    for (size_t i = 0; i < N; ++i) {
+        if (str_equal( specs[ i ].name, name ))
+            return specs[ i ];
+    }
+    throw std::out_of_range( "spec_find: unknown parameter name" );
+}
+
 // =============================================================================
 // class hierarchy
 // ParamBase
@@ -258,6 +595,19 @@ enum class ParamType
 //         ParamChar
 //         ParamEnum (template)
 
+class ParamsBase;
+
+//------------------------------------------------------------------------------
+/// Value of one output column at one point, for sinks such as TableSink.
+/// Numeric columns have value; string-like columns (e.g., type, status
+/// message) also have text, and value is NaN if they have no numeric value.
+struct ParamValue
+{
+    std::string name;   ///< command line name, with field, e.g., "dim.m"
+    double      value;
+    std::string text;
+};
+
 class ParamBase
 {
 public:
@@ -284,6 +634,12 @@ public:
     /// @param[in] help
     ///     Description of parameter to print with `tester -h routine`.
     ///
+    /// The parameter is registered with the ParamsBase object whose
+    /// constructor is running on this thread with a ParamsBase::Registration,
+    /// if any, which is the usual case of parameters that are members of
+    /// a Params class.
+    /// @see ParamsBase::add() to register a parameter explicitly.
+    ///
     ParamBase( const char* in_name, int width, ParamType type,
                const char* help ):
         help_   ( help ),
@@ -291,26 +647,36 @@ public:
         width_  ( width ),
         type_   ( type ),
         is_default_( true ),
-        used_   ( false )
+        used_   ( false ),
+        owner_  ( nullptr )
     {
         name( in_name );
-        s_params.push_back( this );
+        attach();
     }
 
     virtual ~ParamBase()
     {
-        auto iter = std::find( s_params.begin(), s_params.end(), this );
-        if (iter != s_params.end())
-            s_params.erase( iter );
+        detach();
     }
 
+    // Not copyable, since registered by address with its owner.
+    ParamBase( ParamBase const& ) = delete;
+    ParamBase& operator = ( ParamBase const& ) = delete;
+
     virtual void parse( const char* str ) = 0;
     virtual void print() const = 0;
     virtual void reset_output() = 0;
+    virtual void reset() = 0;
     virtual void header( int line ) const;
     virtual void help() const;
     virtual bool next();
     virtual size_t size() const = 0;
+    virtual bool number( std::string const& field,
+                         double* value, bool* is_int ) const;
+    virtual bool number( double value );
+    virtual void values( std::vector< ParamValue >& row ) const;
+    virtual void pack( std::string& buf ) const = 0;
+    virtual const char* unpack( const char* buf ) = 0;
 
     bool used() const { return used_; }
     void used( bool in_used ) { used_ = in_used; }
@@ -346,6 +712,8 @@ public:
             option_ = "--" + std::string(in_option);
         else
             option_ = "--" + name_;
+        if (owner_)
+            reindex();
     }
 
     /// @return Parameter's name.
@@ -357,9 +725,13 @@ public:
     int  width() const { return width_; }
     void width( int w ) { width_ = w; }
 
+    /// @return ParamsBase object that parameter is registered with, or null.
+    ParamsBase* owner() const { return owner_; }
+
 protected:
-    // s_params is list of ParamBase objects, used by Params class
-    static std::vector< ParamBase* > s_params;
+    void attach();
+    void detach();
+    void reindex();
 
     std::string name_;
     std::string option_;
@@ -369,6 +741,7 @@ protected:
     ParamType   type_;
     bool        is_default_;
     int         used_;
+    ParamsBase* owner_;  ///< ParamsBase that parameter is registered with
 };
 
 // =============================================================================
@@ -382,6 +755,7 @@ public:
         default_value_( default_value )
     {
         values_.push_back( default_value );
+        default_values_ = values_;
     }
 
     virtual size_t size() const
@@ -409,9 +783,10 @@ public:
     void set_default( const T& default_value )
     {
         default_value_ = default_value;
+        default_values_.clear();
+        default_values_.push_back( default_value );
         if (is_default_) {
-            values_.clear();
-            values_.push_back( default_value );
+            values_ = default_values_;
         }
     }
 
@@ -422,10 +797,62 @@ public:
         }
     }
 
+    //----------------------------------------
+    /// Restores default values, as before parsing the command line,
+    /// so the same parameter can be parsed again for the next block
+    /// in a sweep specification file.
+    /// List parameters are also marked unused, since the next
+    /// routine marks the parameters it uses.
+    virtual void reset()
+    {
+        values_     = default_values_;
+        index_      = 0;
+        is_default_ = true;
+        if (type_ == ParamType::List)
+            used_ = false;
+    }
+
+    //----------------------------------------
+    /// Appends value at the current point to buf, in binary, e.g., to send
+    /// output values from an isolated child process; see `--isolate`.
+    virtual void pack( std::string& buf ) const
+    {
+        T const& val = values_[ index_ ];
+        if constexpr (std::is_trivially_copyable< T >::value) {
+            buf.append( (const char*) &val, sizeof(T) );
+        }
+        else {
+            // string-like
+            uint64_t len = val.size();
+            buf.append( (const char*) &len, sizeof(len) );
+            buf.append( val.data(), len );
+        }
+    }
+
+    //----------------------------------------
+    /// Sets value at the current point from buf, as packed by pack().
+    /// @return pointer to byte after value in buf.
+    virtual const char* unpack( const char* buf )
+    {
+        T& val = values_[ index_ ];
+        if constexpr (std::is_trivially_copyable< T >::value) {
+            memcpy( (void*) &val, buf, sizeof(T) );
+            return buf + sizeof(T);
+        }
+        else {
+            uint64_t len;
+            memcpy( &len, buf, sizeof(len) );
+            buf += sizeof(len);
+            val.assign( buf, len );
+            return buf + len;
+        }
+    }
+
     void push_back( T val );
 
 protected:
     std::vector< T > values_;
+    std::vector< T > default_values_;  ///< values_ before parsing
     T default_value_;
 };
 
@@ -459,9 +886,25 @@ public:
         max_value_( max_value )
     {}
 
+    /// Parameter declared in a compile-time schema.
+    /// Throws if spec has a non-zero precision, which integers don't have.
+    explicit ParamInt( ParamSpec const& spec ):
+        ParamInt( spec.name, spec.width, spec.type,
+                  int64_t( spec.default_value ),
+                  int64_t( spec.min_value ), int64_t( spec.max_value ),
+                  spec.help )
+    {
+        if (spec.precision != 0)
+            throw_error( "%s: precision must be 0 for an integer parameter",
+                         spec.name );
+    }
+
     virtual void parse( const char* str );
     virtual void print() const;
     virtual void help() const;
+    virtual bool number( std::string const& field,
+                         double* value, bool* is_int ) const;
+    virtual bool number( double value );
     void push_back( int64_t val );
 
 protected:
@@ -517,6 +960,7 @@ public:
             int3_t tmp = { i, i, i };
             values_.push_back( tmp );
         }
+        default_values_ = values_;
     }
 
     /// application gives default range as string
@@ -534,11 +978,15 @@ public:
         values_.clear();
         parse( default_value );
         is_default_ = true;
+        default_values_ = values_;
     }
 
     virtual void parse( const char* str );
     virtual void print() const;
     virtual void header( int line ) const;
+    virtual bool number( std::string const& field,
+                         double* value, bool* is_int ) const;
+    virtual void values( std::vector< ParamValue >& row ) const;
     void push_back( int3_t val );
 
     int64_t& m()
@@ -622,6 +1070,7 @@ public:
         parse( default_value );
         default_value_ = values_[ 0 ];
         is_default_ = true;
+        default_values_ = values_;
     }
 
     template <typename T>
@@ -633,6 +1082,9 @@ public:
     virtual void parse( const char* str );
     virtual void print() const;
     virtual void help() const;
+    virtual bool number( std::string const& field,
+                         double* value, bool* is_int ) const;
+    virtual void values( std::vector< ParamValue >& row ) const;
 
 protected:
     int display_width_;
@@ -655,9 +1107,19 @@ public:
         max_value_( max_value )
     {}
 
+    /// Parameter declared in a compile-time schema.
+    explicit ParamDouble( ParamSpec const& spec ):
+        ParamDouble( spec.name, spec.width, spec.precision, spec.type,
+                     spec.default_value, spec.min_value, spec.max_value,
+                     spec.help )
+    {}
+
     virtual void parse( const char* str );
     virtual void print() const;
     virtual void help() const;
+    virtual bool number( std::string const& field,
+                         double* value, bool* is_int ) const;
+    virtual bool number( double value );
     void push_back( double val );
 
 protected:
@@ -696,6 +1158,9 @@ public:
     virtual void parse( const char* str );
     virtual void print() const;
     virtual void help() const;
+    virtual bool number( std::string const& field,
+                         double* value, bool* is_int ) const;
+    virtual void values( std::vector< ParamValue >& row ) const;
     void push_back( char val );
 
 protected:
@@ -714,6 +1179,7 @@ public:
 
     virtual void parse( const char* str );
     virtual void print() const;
+    virtual void values( std::vector< ParamValue >& row ) const;
     virtual void header( int line ) const;
     virtual void help() const;
     void push_back( const char* str );
@@ -739,6 +1205,9 @@ public:
     virtual void parse( const char* str );
     virtual void print() const;
     virtual void help() const;
+    virtual bool number( std::string const& field,
+                         double* value, bool* is_int ) const;
+    virtual void values( std::vector< ParamValue >& row ) const;
 };
 
 // -----------------------------------------------------------------------------
@@ -792,18 +1261,480 @@ void ParamEnum<ENUM>::help() const
     }
 }
 
+// -----------------------------------------------------------------------------
+/// Enums with an integer underlying type, such as DataType, have the
+/// numeric value of their enumerator, e.g., DataType::Double is 'd'.
+// virtual
+template <typename ENUM>
+bool ParamEnum<ENUM>::number(
+    std::string const& field, double* value, bool* is_int ) const
+{
+    if constexpr (std::is_enum< ENUM >::value) {
+        if (field.empty()) {
+            *value  = double( this->values_[ this->index_ ] );
+            *is_int = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// virtual
+template <typename ENUM>
+void ParamEnum<ENUM>::values( std::vector< ParamValue >& row ) const
+{
+    double value = std::numeric_limits<double>::quiet_NaN();
+    bool is_int;
+    number( "", &value, &is_int );
+    row.push_back( { this->option_.substr( 2 ), value,
+                     to_string( this->values_[ this->index_ ] ) } );
+}
+
+//------------------------------------------------------------------------------
+/// Arithmetic and logical expression over parameters,
+/// used for `--where` constraints and derived parameters (`--nb =dim.m/16`).
+/// The expression is compiled once into a postfix program,
+/// then evaluated for each point in the sweep.
+///
+/// Supports C-like operators with C precedence, from highest to lowest:
+///     ( )  ! - (unary)  * / %  + -  < <= > >=  == !=  &&  ||
+/// Operations on integers are integer operations, e.g., 7/2 = 3.
+/// Operands are numbers (with optional metric or binary prefix, e.g., 1k),
+/// character literals ('d'), parameters by their command line option name
+/// (nb, type), or components of parameters (dim.m, dim.n, dim.k), and
+/// functions min( a, b, ... ), max( a, b, ... ), clamp( x, lo, hi ),
+/// abs( x ), ceildiv( x, y ), roundup( x, y ), log2( x ), sqrt( x ),
+/// floor( x ), ceil( x ).
+///
+class Expression
+{
+public:
+    Expression() {}
+    Expression( const char* str, ParamsBase const& params );
+
+    double eval() const;
+
+    /// @return expression string.
+    std::string const& str() const { return str_; }
+
+protected:
+    enum class OpCode {
+        Const, Param,
+        Neg, Not,
+        Mul, Div, Mod, Add, Sub,
+        Lt, Le, Gt, Ge, Eq, Ne, And, Or,
+        Min, Max, Clamp, Abs, Ceildiv, Roundup, Log2, Sqrt, Floor, Ceil,
+    };
+
+    /// One operation of the postfix program.
+    struct Op {
+        OpCode code;
+        double value;               ///< Const: value
+        bool   is_int;              ///< Const: whether value is integer
+        ParamBase const* param;     ///< Param: parameter
+        std::string field;          ///< Param: component, e.g., "m"
+        int    nargs;               ///< function: number of arguments
+    };
+
+    /// Value on evaluation stack.
+    struct Value {
+        double value;
+        bool   is_int;
+    };
+
+    void compile_or();
+    void compile_and();
+    void compile_equal();
+    void compile_compare();
+    void compile_add();
+    void compile_mul();
+    void compile_unary();
+    void compile_primary();
+    bool match( const char* token );
+    void emit( OpCode code, int nargs=0 );
+
+    std::string str_;
+    std::vector< Op > ops_;
+    mutable std::vector< Value > stack_;
+
+    // state during compile
+    const char* pos_ = nullptr;
+    ParamsBase const* params_ = nullptr;
+};
+
+//------------------------------------------------------------------------------
+/// Database of tuned parameter values, saved by `--tune` and read by
+/// `--param tuned`, e.g., `--nb tuned`. Values are keyed by machine,
+/// routine, datatype, parameter, and size bucket (power of 2). Lookup
+/// interpolates linearly in log2( size ) between buckets.
+/// The file is text, one record per line:
+///
+///     machine routine type param size value
+///
+class TuneDB
+{
+public:
+    TuneDB() {}
+
+    void load( std::string const& filename );
+    void save( std::string const& filename ) const;
+
+    void store( std::string const& routine, std::string const& type,
+                std::string const& param, double size, double value );
+    bool lookup( std::string const& routine, std::string const& type,
+                 std::string const& param, double size,
+                 double* value ) const;
+
+    static std::string const& machine();
+
+protected:
+    struct Record {
+        std::string machine, routine, type, param;
+        double size;
+        double value;
+    };
+
+    std::vector< Record > records_;
+};
+
+// -----------------------------------------------------------------------------
+/// Search strategy for `--tune`.
+enum class TuneStrategy
+{
+    Grid,     ///< evaluate every value
+    Golden,   ///< golden-section search, for unimodal objectives
+    Halving,  ///< successive halving, doubling runs of the better half
+};
+
+size_t tune_search(
+    TuneStrategy strategy, size_t n, int repeat,
+    std::function< double (size_t) > const& eval,
+    double* objective, int* evals );
+
 // =============================================================================
+/// Set of parameters for a sweep. Each ParamsBase object owns the list of
+/// its parameters, so several ParamsBase objects can exist at once,
+/// e.g., one per thread.
+///
 class ParamsBase
 {
 public:
-    ParamsBase() {}
+    friend class ParamBase;
+
+    //----------------------------------------
+    /// While it exists, parameters constructed on this thread are registered
+    /// with the ParamsBase object constructed during its lifetime.
+    /// A Params subclass takes one as a defaulted constructor argument,
+    /// which lasts until the subclass constructor finishes, so exactly the
+    /// subclass's members are registered, e.g.,
+    ///
+    ///     class Params: public testsweeper::ParamsBase {
+    ///     public:
+    ///         Params( Registration reg = Registration() );
+    ///         testsweeper::ParamInt nb;
+    ///     };
+    ///
+    /// Parameters constructed at other times, e.g., a plugin's globals,
+    /// must be registered explicitly with add().
+    ///
+    /// For compatibility, a subclass whose constructor doesn't take a
+    /// Registration, e.g., `Params(): ParamsBase(), ...`, still has its
+    /// members registered: parameters constructed on this thread are
+    /// registered with the most recent such ParamsBase object until it is
+    /// parsed. This is deprecated, since so is any other parameter
+    /// constructed in the meantime.
+    class Registration
+    {
+    public:
+        Registration();
+        ~Registration();
+
+        Registration( Registration const& ) = delete;
+        Registration& operator = ( Registration const& ) = delete;
+
+    private:
+        friend class ParamsBase;
+        friend class ParamBase;
+
+        Registration* prev_;              ///< enclosing registration
+        ParamsBase*   params_ = nullptr;  ///< object to register with
+
+        /// Innermost registration on this thread.
+        static thread_local Registration* s_current;
+    };
+
+    ParamsBase();
+    ~ParamsBase();
+
+    // Not copyable, since parameters are registered by address.
+    ParamsBase( ParamsBase const& ) = delete;
+    ParamsBase& operator = ( ParamsBase const& ) = delete;
+
+    void add( ParamBase* param );
+    void remove( ParamBase* param );
 
     void parse( const char* routine, int n, char** args );
     bool next();
     void header();
     void print();
     void reset_output();
+    void reset();
     void help( const char* routine );
+
+    ParamBase* find( std::string const& name ) const;
+    void values( std::vector< ParamValue >& row );
+
+    /// @return true if no point in the sweep satisfies the constraints.
+    bool empty() const { return empty_; }
+
+    /// @return number of points rejected by `--where` constraints.
+    int64_t rejected() const { return rejected_; }
+
+    /// @return number of points skipped because a derived value,
+    /// e.g., from `--nb =dim.m/16`, is outside its parameter's range.
+    int64_t invalid() const { return invalid_; }
+
+    /// @return error for the first point counted in invalid().
+    std::string const& invalid_message() const { return invalid_message_; }
+
+    int64_t num_points();
+    int64_t point();
+    void seek( int64_t index );
+
+    /// @return seed for random test data, from `--seed`; default 0.
+    uint64_t seed() const { return seed_; }
+
+    uint64_t random_key();
+
+    void verify( Difference const& diff, double tol );
+
+    /// @return true if caching reference results, with `--ref-cache dir`.
+    bool ref_cache() const { return ! ref_cache_dir_.empty(); }
+
+    uint64_t ref_key( const void* input, size_t bytes );
+    const void* ref_find( uint64_t key, size_t bytes );
+    void ref_store( uint64_t key, const void* data, size_t bytes );
+
+    /// @return true if tuning a parameter, with `--tune`.
+    bool tuning() const { return tune_param_ != nullptr; }
+
+    /// @return search strategy, from `--tune-strategy`.
+    TuneStrategy tune_strategy() const { return tune_strategy_; }
+
+    size_t tune_size() const;
+    void   tune_begin();
+    bool   tune_seek( size_t index );
+    bool   tune_next();
+    double tune_objective() const;
+    void   tune_record( size_t best, double objective, int evals );
+    void   tune_print() const;
+    void   tune_save();
+
+    /// @return number of points per isolated child process, from
+    /// `--isolate [N]`; 0 if not isolating.
+    int isolate() const { return isolate_; }
+
+    /// @return number of worker processes, from `--workers N`;
+    /// 0 if running points in this process.
+    int workers() const { return workers_; }
+
+    /// @return arena for test buffers, rewound before each run.
+    Workspace& workspace() { return workspace_; }
+
+    /// @return placement for the current point, from `--mem-policy`,
+    /// e.g., for MemAllocator.
+    MemPlacement const& mem_placement() const { return mem_placement_; }
+
+    void begin_run();
+
+    void apply();
+    void apply_threads();
+    void apply_mem_policy();
+    void scaling( double time );
+    void end_run( double time );
+
+    void monitor_start();
+    void monitor_stop();
+    void monitor_finish( double gflops );
+
+    /// @return true if recording system noise, with `--noise`.
+    bool noise() const { return noise_; }
+
+    /// @return number of runs that may be disturbed by system noise,
+    /// with `--noise`.
+    int64_t disturbed() const { return disturbed_; }
+
+    void bind( int worker=0, int nworkers=1 );
+    void unbind();
+    std::vector< int > bind_cpus( int worker, int nworkers ) const;
+    void print_bind();
+
+    void pack_outputs( std::string& buf );
+    void unpack_outputs( std::string const& buf );
+
+protected:
+    bool advance();
+    bool accept();
+    bool derive();
+    bool admit();
+    void compile();
+    ParamBase* find_option( const char* option, size_t len ) const;
+    ParamBase* find_output( std::string const& name ) const;
+    void tune_key( std::string* type, double* size ) const;
+    void parse_tune( const char* tune, const char* objective,
+                     bool maximize, const char* strategy );
+    void parse_threads();
+    void parse_mem_policy();
+    void parse_noise();
+    void parse_energy();
+    void parse_alloc();
+    std::string ref_path( uint64_t key ) const;
+    void ref_release();
+
+    struct NoiseSample;
+    static void noise_sample( NoiseSample* sample );
+
+    /// Parameter whose value is computed from an expression at each point.
+    struct Derived {
+        ParamBase* param;
+        Expression expr;
+    };
+
+    /// Parameters in order of registration, which is output order.
+    std::vector< ParamBase* > params_;
+
+    /// Object being constructed without a Registration, on this thread,
+    /// until parsed; see Registration.
+    static thread_local ParamsBase* s_constructing;
+
+    // Schema resolved by compile() after parse.
+    std::vector< ParamBase* > lists_;    ///< params with multiple values
+    std::vector< size_t >     radix_;    ///< number of values of lists_
+    std::vector< ParamBase* > columns_;  ///< params with visible columns
+    std::vector< ParamBase* > outputs_;  ///< output params
+    bool compiled_ = false;
+
+    /// Index of parameters by command line option, e.g., "--dim",
+    /// built on first lookup and rebuilt after params are added or renamed.
+    mutable std::unordered_map< std::string, ParamBase* > options_;
+    mutable bool indexed_ = false;
+
+    /// Best value of tuned parameter for one combination of other parameters.
+    struct TuneResult {
+        std::vector< ParamValue > inputs;
+        ParamValue best;
+        double objective;
+        int evals;
+        std::string type;  ///< key for tuning database
+        double size;
+    };
+
+    /// Parameter set from tuning database, with `--param tuned`.
+    struct Tuned {
+        ParamBase* param;
+        double default_value;  ///< if database has no value
+    };
+
+    // Tuning state, set by `--tune`, `--maximize`, etc.
+    ParamBase*   tune_param_    = nullptr;
+    ParamBase*   tune_output_   = nullptr;
+    bool         tune_maximize_ = true;
+    TuneStrategy tune_strategy_ = TuneStrategy::Grid;
+    size_t       tune_pos_      = 0;  ///< position of tune_param_ in lists_
+    std::vector< TuneResult > tune_results_;
+    std::vector< bool > tune_rejected_;  ///< indices rejected in combination
+
+    // Tuning database, for `--tune` results and `--param tuned` lookups.
+    std::string routine_;
+    std::string tune_db_file_;  ///< from `--tune-db`; empty to not save
+    TuneDB tune_db_;
+    bool tune_db_loaded_ = false;
+    std::vector< Tuned > tuned_;
+
+    int isolate_ = 0;
+    int workers_ = 0;
+    uint64_t seed_ = 0;
+
+    /// Reference result file mapped into memory, with `--ref-cache`.
+    struct RefMap {
+        uint64_t key;
+        void*    base;
+        size_t   size;
+    };
+
+    // Reference result cache, with `--ref-cache`.
+    std::string ref_cache_dir_;
+    std::vector< RefMap > ref_maps_;  ///< files mapped at ref_point_
+    int64_t ref_point_ = -1;
+    Workspace workspace_;
+
+    // CPU binding, set by `--bind`.
+    std::string bind_;                  ///< cores, sockets, or CPU list
+    std::vector< int > bind_allowed_;   ///< CPUs allowed at construction
+    int bind_worker_   = 0;
+    int bind_nworkers_ = 1;
+    bool bound_        = false;         ///< bind() applied since unbind()
+
+    // Thread scaling, with `--threads`.
+    ParamBase*           threads_param_    = nullptr;
+    TParamBase< double >* speedup_param_    = nullptr;
+    TParamBase< double >* efficiency_param_ = nullptr;
+    double threads_min_     = 0;  ///< baseline for speedup
+    int    threads_current_ = 0;  ///< set by omp_set_num_threads
+    int    threads_default_ = 0;  ///< omp_get_max_threads at construction
+    std::unordered_map< uint64_t, double > scaling_base_;  ///< base time
+
+    // Memory policy, with `--mem-policy`.
+    TParamBase< MemPolicy >* mem_policy_param_ = nullptr;
+    MemPlacement mem_placement_;  ///< as last set by apply_mem_policy
+
+    /// Counters sampled at start and end of a run, for `--noise`.
+    struct NoiseSample {
+        double  freq;      ///< CPU frequency in MHz, or NaN if unknown
+        int64_t vol_cs;    ///< voluntary context switches
+        int64_t invol_cs;  ///< involuntary context switches
+        int64_t minflt;    ///< minor page faults
+        int64_t majflt;    ///< major page faults
+    };
+
+    // System noise monitoring, with `--noise`.
+    bool monitor_running_ = false;  ///< for `--noise`, `--energy`, `--alloc`
+    bool noise_ = false;
+    NoiseSample noise_begin_;
+    TParamBase< double  >* noise_freq_      = nullptr;
+    TParamBase< int64_t >* noise_vol_cs_    = nullptr;
+    TParamBase< int64_t >* noise_invol_cs_  = nullptr;
+    TParamBase< int64_t >* noise_minflt_    = nullptr;
+    TParamBase< int64_t >* noise_majflt_    = nullptr;
+    TParamBase< int64_t >* noise_disturbed_ = nullptr;
+    int64_t disturbed_ = 0;
+
+    // Energy measurement from RAPL counters, with `--energy`.
+    bool energy_ = false;
+    std::string energy_root_ = "/sys/class/powercap";
+    std::vector< std::string > energy_zones_;
+    std::vector< int64_t > energy_begin_;
+    bool   energy_begin_ok_ = false;
+    double energy_wtime_ = 0;
+    double energy_power_ = 0;  ///< average power of last run, in W
+    TParamBase< double >* energy_param_    = nullptr;
+    TParamBase< double >* gflop_per_joule_ = nullptr;
+
+    // Memory footprint and heap allocations, with `--alloc`.
+    bool alloc_ = false;
+    AllocStats alloc_begin_;
+    int64_t alloc_rss_begin_ = 0;  ///< RSS, or peak RSS, at start, in KiB
+    TParamBase< int64_t >* alloc_peak_rss_ = nullptr;
+    TParamBase< int64_t >* alloc_count_    = nullptr;
+    TParamBase< int64_t >* alloc_bytes_    = nullptr;
+
+    std::vector< Expression > where_;
+    std::vector< Derived > derived_;
+    int64_t rejected_ = 0;
+    int64_t invalid_ = 0;
+    std::string invalid_message_;
+    bool empty_ = false;
 };
 
 //------------------------------------------------------------------------------
@@ -832,6 +1763,54 @@ void print_stats( ParamBase const& param, std::vector<T> const& data )
     }
 }
 
+//------------------------------------------------------------------------------
+/// Aggregates results of a sweep, grouped by datatype and by size class,
+/// to print with `--summary y` after all tests are done.
+/// For each group, it tracks the best and worst Gflop/s point,
+/// the geometric mean speedup over the reference, and failure count.
+///
+class Summary
+{
+public:
+    Summary() {}
+
+    void add( std::string const& type, int64_t size,
+              double gflops, double ref_gflops, int64_t okay );
+    void print() const;
+
+    /// Sets number of points rejected by `--where` constraints.
+    void rejected( int64_t count ) { rejected_ = count; }
+
+    /// Sets number of times each point was repeated, with `--repeat`.
+    /// Each repeat is added, and counted, as a separate test.
+    void repeat( int64_t count ) { repeat_ = count; }
+
+    static std::string size_class( int64_t size );
+
+protected:
+    //----------------------------------------
+    /// Aggregate for one group.
+    struct Group {
+        std::string key;
+        int64_t count          = 0;
+        int64_t failed         = 0;
+        double  best           = 0;
+        double  worst          = 0;
+        std::string best_at;
+        std::string worst_at;
+        double  log_speedup    = 0;  ///< sum of log( gflops / ref_gflops )
+        int64_t speedup_count  = 0;
+    };
+
+    static Group& find( std::vector< Group >& groups, std::string const& key );
+    static void print( const char* label, std::vector< Group > const& groups );
+
+    std::vector< Group > by_type_;
+    std::vector< Group > by_size_;
+    int64_t rejected_ = 0;
+    int64_t repeat_   = 1;
+};
+
 }  // namespace testsweeper
 
 // =============================================================================
@@ -853,6 +1832,67 @@ test_func_ptr find_tester(
     const char *name,
     std::vector< routines_t >& routines );
 
+// -----------------------------------------------------------------------------
+/// Index of a routines table by name, for repeated lookups, e.g., for each
+/// block of a `--spec` file. It is built once from the table, and isn't
+/// updated if the table changes, so build it after all routines are added.
+class RoutineIndex
+{
+public:
+    explicit RoutineIndex( std::vector< routines_t > const& routines );
+
+    test_func_ptr find( const char* name ) const;
+
+protected:
+    std::unordered_map< std::string, test_func_ptr > index_;
+};
+
+test_func_ptr find_tester(
+    const char *name,
+    RoutineIndex const& index );
+
+std::vector< routines_t >& registered_routines();
+
+/// Function `testsweeper_plugin`, with C linkage, that a plugin may export
+/// to add its routines and parameters; see load_plugin.
+typedef void (*plugin_func_ptr)(
+    std::vector< routines_t >& routines, ParamsBase& params );
+
+void load_plugin(
+    const char* filename,
+    std::vector< routines_t >& routines,
+    ParamsBase& params );
+
+// -----------------------------------------------------------------------------
+/// Adds a routine to registered_routines() during static initialization;
+/// see TESTSWEEPER_ROUTINE.
+class RegisterRoutine
+{
+public:
+    RegisterRoutine( const char* name, test_func_ptr func, int section );
+};
+
+}  // namespace testsweeper
+
+#define TESTSWEEPER_CONCAT_( a, b ) a ## b
+#define TESTSWEEPER_CONCAT( a, b )  TESTSWEEPER_CONCAT_( a, b )
+
+//------------------------------------------------------------------------------
+/// Registers routine `name`, tested by `func`, in the given usage section,
+/// so a tester's routines can be declared next to their test functions
+/// instead of in one hand-maintained table, e.g.,
+///
+///     TESTSWEEPER_ROUTINE( "gemm", test_gemm, Section::blas3 );
+///
+/// The application adds registered_routines() to its routines table,
+/// e.g., after the last routine in the same section; see test/test.cc.
+#define TESTSWEEPER_ROUTINE( name, func, section ) \
+    static testsweeper::RegisterRoutine \
+        TESTSWEEPER_CONCAT( testsweeper_routine_, __LINE__ )( \
+            name, func, section )
+
+namespace testsweeper {
+
 void usage(
     int argc, char **argv,
     std::vector< routines_t >& routines,
@@ -861,6 +1901,596 @@ void usage(
 
 double get_wtime();
 
+std::vector< std::vector< std::string > > read_spec( const char* filename );
+
+// =============================================================================
+// Embeddable sweeps.
+// run_sweep runs a routine over all points of a parsed sweep, reporting
+// results to a Sink, so applications such as autotuners can get results
+// in-process, as data, instead of running the tester and parsing its output.
+// params_t is the application's Params class, with the conventional members
+// repeat, okay, time, gflops, ref_time, and ref_gflops.
+
+//------------------------------------------------------------------------------
+/// Receives results from run_sweep. Hooks are called in order:
+/// begin once; for each point, begin_point, then for each repetition,
+/// error if the routine threw, and result; then end_point; finally end once.
+///
+template <typename params_t>
+class Sink
+{
+public:
+    virtual ~Sink() {}
+
+    virtual void begin( params_t& ) {}
+    virtual void begin_point( params_t& ) {}
+    virtual void error( params_t&, const char* ) {}
+    virtual void result( params_t& params, int iter ) = 0;
+    virtual void end_point( params_t& ) {}
+    virtual void end( params_t&, int ) {}
+};
+
+//------------------------------------------------------------------------------
+/// Prints results as a table, with statistics when repeating each test,
+/// and a final pass/fail line. This is the tester's usual output.
+///
+template <typename params_t>
+class PrintSink : public Sink< params_t >
+{
+public:
+    virtual void begin( params_t& params )
+    {
+        params.header();
+    }
+
+    virtual void error( params_t&, const char* msg )
+    {
+        // keep error in order with rows before it, if both go to a file
+        fflush( stdout );
+        fprintf( stderr, "%s%sError: %s%s\n",
+                 ansi_bold, ansi_red, msg, ansi_normal );
+    }
+
+    virtual void result( params_t& params, int )
+    {
+        // Collect stats, without marking outputs the routine didn't use.
+        params_t const& cparams = params;
+        times_     .push_back( cparams.time() );
+        gflops_    .push_back( cparams.gflops() );
+        ref_times_ .push_back( cparams.ref_time() );
+        ref_gflops_.push_back( cparams.ref_gflops() );
+
+        params.print();
+    }
+
+    virtual void end_point( params_t& params )
+    {
+        if (times_.size() > 1) {
+            print_stats( params.time,       times_      );
+            print_stats( params.ref_time,   ref_times_  );
+            print_stats( params.gflops,     gflops_     );
+            print_stats( params.ref_gflops, ref_gflops_ );
+            printf( "\n" );
+        }
+        times_     .clear();
+        gflops_    .clear();
+        ref_times_ .clear();
+        ref_gflops_.clear();
+    }
+
+    virtual void end( params_t& params, int failures )
+    {
+        if (failures) {
+            printf( "%d tests FAILED.\n", failures );
+        }
+        else {
+            printf( "All tests passed.\n" );
+        }
+        if (params.rejected() > 0) {
+            printf( "%lld points rejected by --where constraints.\n",
+                    (long long) params.rejected() );
+        }
+        if (params.invalid() > 0) {
+            printf( "%lld points skipped with derived value out of range,"
+                    " e.g., %s.\n",
+                    (long long) params.invalid(),
+                    params.invalid_message().c_str() );
+        }
+        if (params.noise()) {
+            printf( "%lld runs may be disturbed by system noise;"
+                    " see disturbed column.\n",
+                    (long long) params.disturbed() );
+        }
+        if (params.tuning()) {
+            params.tune_print();
+        }
+    }
+
+protected:
+    std::vector< double > times_, ref_times_, gflops_, ref_gflops_;
+};
+
+//------------------------------------------------------------------------------
+/// Collects results as a table of rows, one row per point and repetition,
+/// each with values of the visible, used columns; see ParamsBase::values.
+///
+template <typename params_t>
+class TableSink : public Sink< params_t >
+{
+public:
+    virtual void result( params_t& params, int )
+    {
+        rows_.emplace_back();
+        params.values( rows_.back() );
+    }
+
+    /// @return rows of results collected so far.
+    std::vector< std::vector< ParamValue > > const& rows() const
+    {
+        return rows_;
+    }
+
+protected:
+    std::vector< std::vector< ParamValue > > rows_;
+};
+
+//------------------------------------------------------------------------------
+/// Calls a function with params after each run of the routine, to read
+/// output values directly, e.g., params.gflops().
+///
+template <typename params_t>
+class CallbackSink : public Sink< params_t >
+{
+public:
+    CallbackSink( std::function< void (params_t&) > callback ):
+        callback_( callback )
+    {}
+
+    virtual void result( params_t& params, int )
+    {
+        callback_( params );
+    }
+
+protected:
+    std::function< void (params_t&) > callback_;
+};
+
+// Sweep variants that run_sweep dispatches to; defined below.
+template <typename params_t>
+int tune_sweep( params_t& params, test_func_ptr routine,
+                Sink< params_t >& sink );
+
+template <typename params_t>
+int isolate_sweep( params_t& params, test_func_ptr routine,
+                   Sink< params_t >& sink );
+
+template <typename params_t>
+int workers_sweep( params_t& params, test_func_ptr routine,
+                   Sink< params_t >& sink );
+
+//------------------------------------------------------------------------------
+/// Runs routine at each point of a sweep that has already been parsed,
+/// repeating each point params.repeat() times, and reports results to sink.
+/// If routine throws, the error is reported to sink and the test fails.
+///
+/// @param[in,out] params
+///     Application's parameters, already parsed.
+///
+/// @param[in] routine
+///     Test routine to run.
+///
+/// @param[in,out] sink
+///     Receives results.
+///
+/// @return number of failed tests.
+///
+template <typename params_t>
+int run_sweep( params_t& params, test_func_ptr routine, Sink< params_t >& sink )
+{
+    if (params.tuning())
+        return tune_sweep( params, routine, sink );
+    if (params.workers() > 0)
+        return workers_sweep( params, routine, sink );
+    if (params.isolate() > 0)
+        return isolate_sweep( params, routine, sink );
+
+    int failures = 0;
+    int repeat = params.repeat();
+    sink.begin( params );
+    bool more = ! params.empty();
+    while (more) {
+        params.apply();
+        sink.begin_point( params );
+        for (int iter = 0; iter < repeat; ++iter) {
+            params.begin_run();
+            params.monitor_start();
+            try {
+                routine( params, true );
+            }
+            catch (const std::exception& ex) {
+                sink.error( params, ex.what() );
+                params.okay() = false;
+            }
+            params.monitor_finish( std::as_const( params ).gflops() );
+            params.end_run( params.time() );
+            sink.result( params, iter );
+            failures += ! params.okay();
+            params.reset_output();
+        }
+        sink.end_point( params );
+        more = params.next();
+    }
+    sink.end( params, failures );
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+/// Child process for `--isolate` and `--workers`, which runs test points and
+/// sends their output values back to the parent over a pipe, so a crash or
+/// leak in one point doesn't affect the rest of the sweep.
+/// Worker children receive indices of points to run over a second pipe.
+///
+class Isolate
+{
+public:
+    Isolate() {}
+    ~Isolate();
+
+    Isolate( Isolate const& ) = delete;
+    Isolate& operator = ( Isolate const& ) = delete;
+
+    bool fork();
+
+    // in child
+    void send( std::string const& error, std::string const& outputs );
+    bool receive_point( int64_t* point );
+    void detach();
+    [[noreturn]] void exit();
+
+    // in parent
+    void assign( int64_t point );
+    bool receive( std::string* error, std::string* outputs );
+    std::string finish();
+
+    static size_t poll(
+        std::vector< std::unique_ptr< Isolate > > const& children );
+
+protected:
+    int     fd_     = -1;  ///< results: write end in child, read end in parent
+    int     cmd_fd_ = -1;  ///< points: read end in child, write end in parent
+    int64_t pid_    = -1;
+};
+
+//------------------------------------------------------------------------------
+/// Runs sweep as run_sweep, but each block of params.isolate() points runs in
+/// a child process forked from this one. After each run, the child sends
+/// output values to the parent, which reports them to sink.
+/// If the child crashes, the run in progress fails with an error describing
+/// the signal or exit status, and the sweep continues at the next point in
+/// a new child process.
+///
+/// @return number of failed tests.
+///
+template <typename params_t>
+int isolate_sweep( params_t& params, test_func_ptr routine,
+                   Sink< params_t >& sink )
+{
+    int failures = 0;
+    int repeat = params.repeat();
+    sink.begin( params );
+    bool more = ! params.empty();
+    while (more) {
+        Isolate child;
+        if (child.fork()) {
+            // child: run block of points, sending outputs after each run
+            params.bind();
+            for (int p = 0; p < params.isolate(); ++p) {
+                params.apply();
+                for (int iter = 0; iter < repeat; ++iter) {
+                    std::string error, outputs;
+                    params.begin_run();
+                    params.monitor_start();
+                    try {
+                        routine( params, true );
+                    }
+                    catch (const std::exception& ex) {
+                        error = ex.what();
+                        params.okay() = false;
+                    }
+                    params.monitor_finish(
+                        std::as_const( params ).gflops() );
+                    params.pack_outputs( outputs );
+                    child.send( error, outputs );
+                    params.reset_output();
+                }
+                if (! params.next())
+                    break;
+            }
+            child.exit();
+        }
+
+        // parent: receive outputs for same block of points
+        bool crashed = false;
+        for (int p = 0; p < params.isolate() && more && ! crashed; ++p) {
+            sink.begin_point( params );
+            for (int iter = 0; iter < repeat && ! crashed; ++iter) {
+                std::string error, outputs;
+                if (child.receive( &error, &outputs )) {
+                    params.unpack_outputs( outputs );
+                    params.end_run( params.time() );
+                }
+                else {
+                    crashed = true;
+                    error = child.finish();
+                    params.okay() = false;
+                }
+                if (! error.empty())
+                    sink.error( params, error.c_str() );
+                sink.result( params, iter );
+                failures += ! params.okay();
+                params.reset_output();
+            }
+            sink.end_point( params );
+            more = params.next();
+        }
+    }
+    sink.end( params, failures );
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+/// Runs sweep as run_sweep, but hands points to params.workers() child
+/// processes forked from this one, so each worker can use its own set of
+/// cores, e.g., for routines that are multithreaded themselves.
+/// Each worker is given the next point as soon as it finishes its last one.
+/// The parent collects results and reports them to sink in the usual order
+/// of points, so output and statistics are the same as run_sweep.
+/// As with isolate_sweep, if a worker crashes, the run in progress fails
+/// and a new worker replaces it.
+///
+/// @return number of failed tests.
+///
+template <typename params_t>
+int workers_sweep( params_t& params, test_func_ptr routine,
+                   Sink< params_t >& sink )
+{
+    struct Run {
+        std::string error, outputs;
+        bool crashed;
+    };
+
+    // Points that satisfy constraints, in the usual order.
+    std::vector< int64_t > points;
+    bool more = ! params.empty();
+    while (more) {
+        points.push_back( params.point() );
+        more = params.next();
+    }
+
+    int failures = 0;
+    size_t repeat = params.repeat();
+    size_t nworkers = std::min( size_t( params.workers() ), points.size() );
+    std::vector< std::vector< Run > > runs( points.size() );
+    std::vector< std::unique_ptr< Isolate > > workers( nworkers );
+    std::vector< size_t > assigned( nworkers );  // index into points
+    size_t next_point = 0;
+
+    // Gives worker w the next point; finishes it if there are none left.
+    auto assign = [&]( size_t w ) {
+        if (next_point < points.size()) {
+            assigned[ w ] = next_point++;
+            workers[ w ]->assign( points[ assigned[ w ] ] );
+        }
+        else {
+            workers[ w ]->finish();
+        }
+    };
+
+    // Forks worker w, which runs points until parent finishes it.
+    auto spawn = [&]( size_t w ) {
+        workers[ w ].reset( new Isolate );
+        if (workers[ w ]->fork()) {
+            Isolate& child = *workers[ w ];
+            for (size_t j = 0; j < nworkers; ++j) {
+                if (j != w && workers[ j ])
+                    workers[ j ]->detach();
+            }
+            params.bind( w, nworkers );
+            int64_t point;
+            while (child.receive_point( &point )) {
+                params.seek( point );
+                params.apply();
+                for (size_t iter = 0; iter < repeat; ++iter) {
+                    std::string error, outputs;
+                    params.begin_run();
+                    params.monitor_start();
+                    try {
+                        routine( params, true );
+                    }
+                    catch (const std::exception& ex) {
+                        error = ex.what();
+                        params.okay() = false;
+                    }
+                    params.monitor_finish(
+                        std::as_const( params ).gflops() );
+                    params.pack_outputs( outputs );
+                    child.send( error, outputs );
+                    params.reset_output();
+                }
+            }
+            child.exit();
+        }
+        assign( w );
+    };
+
+    sink.begin( params );
+    for (size_t w = 0; w < nworkers; ++w) {
+        spawn( w );
+    }
+
+    size_t done = 0;
+    while (done < points.size()) {
+        // Report points that are complete, in order.
+        auto complete = [&]( std::vector< Run > const& r ) {
+            return r.size() == repeat || (! r.empty() && r.back().crashed);
+        };
+        while (done < points.size() && complete( runs[ done ] )) {
+            params.seek( points[ done ] );
+            sink.begin_point( params );
+            int iter = 0;
+            for (auto const& run : runs[ done ]) {
+                if (run.crashed) {
+                    params.okay() = false;
+                }
+                else {
+                    params.unpack_outputs( run.outputs );
+                    params.end_run( params.time() );
+                }
+                if (! run.error.empty())
+                    sink.error( params, run.error.c_str() );
+                sink.result( params, iter++ );
+                failures += ! params.okay();
+                params.reset_output();
+            }
+            sink.end_point( params );
+            std::vector< Run >().swap( runs[ done ] );
+            ++done;
+        }
+        if (done == points.size())
+            break;
+
+        // Receive one run from a worker.
+        size_t w = Isolate::poll( workers );
+        Run run;
+        run.crashed = ! workers[ w ]->receive( &run.error, &run.outputs );
+        if (run.crashed)
+            run.error = workers[ w ]->finish();
+        auto& r = runs[ assigned[ w ] ];
+        r.push_back( run );
+        if (run.crashed)
+            spawn( w );
+        else if (r.size() == repeat)
+            assign( w );
+    }
+    sink.end( params, failures );
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+/// Tunes one parameter, as set by `--tune`, at each combination of the
+/// other parameters: searches its values using params.tune_strategy(),
+/// running each evaluated point params.repeat() times and averaging the
+/// objective. Failed runs and rejected points have objective -infinity.
+/// Each run is reported to sink; best values are recorded in params,
+/// for PrintSink to print in a compact table at the end.
+///
+/// @return number of failed tests.
+///
+template <typename params_t>
+int tune_sweep( params_t& params, test_func_ptr routine,
+                Sink< params_t >& sink )
+{
+    int failures = 0;
+    sink.begin( params );
+    params.tune_begin();
+    do {
+        int runs = 0;  // excludes rejected points, unlike tune_search's evals
+        auto eval = [&]( size_t index ) {
+            if (! params.tune_seek( index ))
+                return -std::numeric_limits< double >::infinity();
+
+            runs += 1;
+            params.apply();
+            sink.begin_point( params );
+            params.begin_run();
+            params.monitor_start();
+            try {
+                routine( params, true );
+            }
+            catch (const std::exception& ex) {
+                sink.error( params, ex.what() );
+                params.okay() = false;
+            }
+            params.monitor_finish( std::as_const( params ).gflops() );
+            params.end_run( params.time() );
+            sink.result( params, 0 );
+            bool failed = (params.okay() == 0);
+            failures += failed;
+            double objective = failed
+                             ? -std::numeric_limits< double >::infinity()
+                             : params.tune_objective();
+            params.reset_output();
+            sink.end_point( params );
+            return objective;
+        };
+        double objective;
+        int evals;
+        size_t best = tune_search( params.tune_strategy(), params.tune_size(),
+                                   params.repeat(), eval, &objective, &evals );
+        params.tune_record( best, objective, runs );
+    } while (params.tune_next());
+    params.tune_save();
+    sink.end( params, failures );
+    return failures;
+}
+
+//------------------------------------------------------------------------------
+/// Finds routine, parses args, and runs the sweep, as the tester does for
+/// `tester [params] routine`. To run another sweep with the same params,
+/// call params.reset() first.
+///
+/// @param[in,out] params
+///     Application's parameters.
+///
+/// @param[in] index
+///     Index of routines to search for routine name;
+///     build it once to run several sweeps.
+///
+/// @param[in] args
+///     Arguments: [parameters] routine, e.g., { "--dim", "100:500:100", "gemm" }.
+///
+/// @param[in,out] sink
+///     Receives results.
+///
+/// @return number of failed tests.
+///
+template <typename params_t>
+int run_sweep( params_t& params,
+               RoutineIndex const& index,
+               std::vector< std::string > const& args,
+               Sink< params_t >& sink )
+{
+    if (args.empty())
+        throw_error( "missing routine" );
+
+    const char* name = args.back().c_str();
+    test_func_ptr routine = find_tester( name, index );
+    if (routine == nullptr)
+        throw_error( "routine %s not found", name );
+
+    // mark fields that are used (run=false)
+    routine( params, false );
+
+    std::vector< char* > argv;
+    for (size_t i = 0; i + 1 < args.size(); ++i)
+        argv.push_back( const_cast< char* >( args[ i ].c_str() ) );
+    params.parse( name, argv.size(), argv.data() );
+
+    return run_sweep( params, routine, sink );
+}
+
+//------------------------------------------------------------------------------
+/// Runs the sweep as above, looking up routine name in routines.
+///
+template <typename params_t>
+int run_sweep( params_t& params,
+               std::vector< routines_t >& routines,
+               std::vector< std::string > const& args,
+               Sink< params_t >& sink )
+{
+    return run_sweep( params, RoutineIndex( routines ), args, sink );
+}
+
 }  // namespace testweeper
 
 #endif        //  #ifndef LIBTEST_HH
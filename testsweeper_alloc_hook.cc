@@ -0,0 +1,124 @@
+// Copyright (c) 2017-2023, University of Tennessee. All rights reserved.
+// SPDX-License-Identifier: BSD-3-Clause
+// This program is free software: you can redistribute it and/or modify it under
+// the terms of the BSD 3-Clause license. See the accompanying LICENSE file.
+
+// Interposed allocators that count heap allocations for `--alloc`.
+// These are kept out of the TestSweeper library, so it doesn't replace the
+// application's allocator; a tester links this object to count allocations,
+// e.g., in CMake, target_link_libraries( tester testsweeper_alloc_hook ).
+//
+// With glibc, malloc and related functions are replaced, forwarding to
+// glibc's __libc_* entry points, and free is replaced to match, so memory
+// is always freed by the allocator that allocated it. operator new calls
+// malloc, so it is counted too. Elsewhere, only the global operator new
+// and delete are replaced.
+
+#include <stdlib.h>
+#include <errno.h>
+#include <new>
+
+#include "testsweeper.hh"
+
+#if defined( __GLIBC__ )
+
+extern "C" {
+
+void* __libc_malloc( size_t size );
+void* __libc_calloc( size_t n, size_t size );
+void* __libc_realloc( void* ptr, size_t size );
+void* __libc_memalign( size_t alignment, size_t size );
+void  __libc_free( void* ptr );
+
+void* malloc( size_t size ) noexcept
+{
+    testsweeper::alloc_count( size );
+    return __libc_malloc( size );
+}
+
+void* calloc( size_t n, size_t size ) noexcept
+{
+    testsweeper::alloc_count( n * size );
+    return __libc_calloc( n, size );
+}
+
+void* realloc( void* ptr, size_t size ) noexcept
+{
+    if (size > 0)
+        testsweeper::alloc_count( size );
+    return __libc_realloc( ptr, size );
+}
+
+int posix_memalign( void** ptr, size_t alignment, size_t size ) noexcept
+{
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+    void* p = __libc_memalign( alignment, size );
+    if (p == nullptr)
+        return ENOMEM;
+    testsweeper::alloc_count( size );
+    *ptr = p;
+    return 0;
+}
+
+void* aligned_alloc( size_t alignment, size_t size ) noexcept
+{
+    testsweeper::alloc_count( size );
+    return __libc_memalign( alignment, size );
+}
+
+void free( void* ptr ) noexcept
+{
+    __libc_free( ptr );
+}
+
+}  // extern "C"
+
+#else
+
+void* operator new( size_t size )
+{
+    testsweeper::alloc_count( size );
+    void* ptr = malloc( size > 0 ? size : 1 );
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[]( size_t size )
+{
+    return operator new( size );
+}
+
+void* operator new( size_t size, std::nothrow_t const& ) noexcept
+{
+    testsweeper::alloc_count( size );
+    return malloc( size > 0 ? size : 1 );
+}
+
+void* operator new[]( size_t size, std::nothrow_t const& nothrow ) noexcept
+{
+    return operator new( size, nothrow );
+}
+
+void operator delete( void* ptr ) noexcept
+{
+    free( ptr );
+}
+
+void operator delete[]( void* ptr ) noexcept
+{
+    free( ptr );
+}
+
+void operator delete( void* ptr, size_t ) noexcept
+{
+    free( ptr );
+}
+
+void operator delete[]( void* ptr, size_t ) noexcept
+{
+    free( ptr );
+}
+
+#endif  // __GLIBC__